@@ -0,0 +1,228 @@
+#pragma once
+
+// A/B benchmark for setting profiles.
+// Profiles are alternated segment by segment (A B A B ...) so slow drift, like the game warming its caches, affects both equally.
+// Statistics are plain C++ on frame times in milliseconds, so a run can be checked with made-up frame times.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Benchmark
+{
+    inline constexpr size_t MaxProfiles = 3;
+
+    struct Summary
+    {
+        size_t frames = 0;
+        double mean = 0.0;      // Milliseconds
+        double p50 = 0.0;
+        double p99 = 0.0;
+    };
+
+    inline Summary Summarise(std::vector<double> frameTimes)
+    {
+        Summary summary{};
+        summary.frames = frameTimes.size();
+        if (frameTimes.empty())
+            return summary;
+
+        double total = 0.0;
+        for (double frameTime : frameTimes)
+            total += frameTime;
+        summary.mean = total / static_cast<double>(frameTimes.size());
+
+        auto percentile = [&](double fraction) {
+            const size_t index = std::min(frameTimes.size() - 1, static_cast<size_t>(fraction * static_cast<double>(frameTimes.size())));
+            std::nth_element(frameTimes.begin(), frameTimes.begin() + index, frameTimes.end());
+            return frameTimes[index];
+            };
+        summary.p50 = percentile(0.50);
+        summary.p99 = percentile(0.99);
+        return summary;
+    }
+
+    // Regularised incomplete beta function I_x(a, b), continued fraction (Numerical Recipes, betacf).
+    inline double IncompleteBeta(double a, double b, double x)
+    {
+        if (x <= 0.0)
+            return 0.0;
+        if (x >= 1.0)
+            return 1.0;
+        if (x > (a + 1.0) / (a + b + 2.0))
+            return 1.0 - IncompleteBeta(b, a, 1.0 - x);
+
+        const double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x)) / a;
+        constexpr double Tiny = 1e-300;
+        double c = 1.0;
+        double d = 1.0 - (a + b) * x / (a + 1.0);
+        d = 1.0 / (std::abs(d) < Tiny ? Tiny : d);
+        double result = d;
+        for (int m = 1; m <= 200; ++m) {
+            for (int step = 0; step < 2; ++step) {
+                const double numerator = (step == 0)
+                    ? m * (b - m) * x / ((a + 2.0 * m - 1.0) * (a + 2.0 * m))
+                    : -(a + m) * (a + b + m) * x / ((a + 2.0 * m) * (a + 2.0 * m + 1.0));
+                d = 1.0 + numerator * d;
+                d = 1.0 / (std::abs(d) < Tiny ? Tiny : d);
+                c = 1.0 + numerator / c;
+                c = std::abs(c) < Tiny ? Tiny : c;
+                result *= c * d;
+            }
+            if (std::abs(c * d - 1.0) < 1e-12)
+                break;
+        }
+        return front * result;
+    }
+
+    struct Welch
+    {
+        double t = 0.0;
+        double df = 0.0;
+        double p = 1.0;         // Two-tailed
+    };
+
+    // Welch's t-test. Needs at least two samples on each side.
+    inline Welch WelchTest(const std::vector<double>& a, const std::vector<double>& b)
+    {
+        Welch result{};
+        if (a.size() < 2 || b.size() < 2)
+            return result;
+
+        auto meanVariance = [](const std::vector<double>& samples) {
+            double mean = 0.0;
+            for (double sample : samples)
+                mean += sample;
+            mean /= static_cast<double>(samples.size());
+            double variance = 0.0;
+            for (double sample : samples)
+                variance += (sample - mean) * (sample - mean);
+            return std::pair{ mean, variance / static_cast<double>(samples.size() - 1) };
+            };
+
+        const auto [meanA, varianceA] = meanVariance(a);
+        const auto [meanB, varianceB] = meanVariance(b);
+        const double errorA = varianceA / static_cast<double>(a.size());
+        const double errorB = varianceB / static_cast<double>(b.size());
+        if (errorA + errorB <= 0.0)
+            return result;
+
+        result.t = (meanA - meanB) / std::sqrt(errorA + errorB);
+        result.df = (errorA + errorB) * (errorA + errorB)
+            / (errorA * errorA / static_cast<double>(a.size() - 1) + errorB * errorB / static_cast<double>(b.size() - 1));
+        result.p = IncompleteBeta(result.df / 2.0, 0.5, result.df / (result.df + result.t * result.t));
+        return result;
+    }
+
+    // Schedules the segments and collects frame times. Drive it with Frame() once per presented frame.
+    class Run
+    {
+    public:
+        enum class Action
+        {
+            None,
+            Switch,     // Apply profile Profile() now
+            Finished
+        };
+
+        Run(size_t profiles, size_t segmentsPerProfile, double segmentSeconds, double settleSeconds)
+            : m_profiles(std::clamp<size_t>(profiles, 1, MaxProfiles)), m_segments(m_profiles * segmentsPerProfile),
+            m_segmentSeconds(segmentSeconds), m_settleSeconds(settleSeconds)
+        {
+        }
+
+        Action Frame(double now)
+        {
+            if (m_segment >= m_segments)
+                return Action::None;
+
+            if (m_segmentStart < 0.0) {
+                Begin(now);
+                return Action::Switch;
+            }
+
+            const double frameTime = (now - m_lastFrame) * 1000.0;
+            m_lastFrame = now;
+            if (now - m_segmentStart < m_settleSeconds)
+                return Action::None;
+
+            m_segmentFrames.push_back(frameTime);
+            if (now - m_segmentStart < m_settleSeconds + m_segmentSeconds)
+                return Action::None;
+
+            // Segment done. Its mean is one sample for the significance test, since frame times within a segment are correlated.
+            double total = 0.0;
+            for (double sample : m_segmentFrames)
+                total += sample;
+            m_segmentMeans[Profile()].push_back(total / static_cast<double>(m_segmentFrames.size()));
+            m_frames[Profile()].insert(m_frames[Profile()].end(), m_segmentFrames.begin(), m_segmentFrames.end());
+            m_segmentFrames.clear();
+
+            if (++m_segment >= m_segments)
+                return Action::Finished;
+            Begin(now);
+            return Action::Switch;
+        }
+
+        size_t Profile() const { return m_segment % m_profiles; }
+        size_t Segment() const { return m_segment; }
+        size_t Segments() const { return m_segments; }
+        bool Finished() const { return m_segment >= m_segments; }
+
+        // Plain text comparison of every profile against the first.
+        std::string Report(const std::vector<std::string>& names) const
+        {
+            std::string report{};
+            char line[256];
+            snprintf(line, sizeof(line), "%zu profile(s), %zu segment(s) of %.0fs each after %.0fs to settle.\n\n",
+                m_profiles, m_segments, m_segmentSeconds, m_settleSeconds);
+            report += line;
+            snprintf(line, sizeof(line), "%-16s %8s %10s %8s %10s %10s\n", "Profile", "Frames", "Mean (ms)", "FPS", "p50 (ms)", "p99 (ms)");
+            report += line;
+
+            Summary summaries[MaxProfiles]{};
+            for (size_t i = 0; i < m_profiles; ++i) {
+                summaries[i] = Summarise(m_frames[i]);
+                snprintf(line, sizeof(line), "%-16s %8zu %10.3f %8.1f %10.3f %10.3f\n", Name(names, i).c_str(), summaries[i].frames,
+                    summaries[i].mean, summaries[i].mean > 0.0 ? 1000.0 / summaries[i].mean : 0.0, summaries[i].p50, summaries[i].p99);
+                report += line;
+            }
+
+            report += "\nWelch's t-test on segment mean frame times, against the first profile:\n";
+            for (size_t i = 1; i < m_profiles; ++i) {
+                const Welch welch = WelchTest(m_segmentMeans[i], m_segmentMeans[0]);
+                const double change = summaries[0].mean > 0.0 ? (summaries[i].mean - summaries[0].mean) / summaries[0].mean * 100.0 : 0.0;
+                snprintf(line, sizeof(line), "%-16s mean %+.2f%%, p99 %+.3fms, t = %.3f, df = %.1f, p = %.4f (%s)\n", Name(names, i).c_str(),
+                    change, summaries[i].p99 - summaries[0].p99, welch.t, welch.df, welch.p, welch.p < 0.05 ? "significant at 5%" : "not significant");
+                report += line;
+            }
+            return report;
+        }
+
+    private:
+        size_t m_profiles;
+        size_t m_segments;
+        double m_segmentSeconds;
+        double m_settleSeconds;
+        size_t m_segment = 0;
+        double m_segmentStart = -1.0;
+        double m_lastFrame = 0.0;
+        std::vector<double> m_segmentFrames{};
+        std::vector<double> m_frames[MaxProfiles]{};
+        std::vector<double> m_segmentMeans[MaxProfiles]{};
+
+        void Begin(double now)
+        {
+            m_segmentStart = now;
+            m_lastFrame = now;
+        }
+
+        static std::string Name(const std::vector<std::string>& names, size_t index)
+        {
+            return index < names.size() ? names[index] : "Profile " + std::to_string(index + 1);
+        }
+    };
+}
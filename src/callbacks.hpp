@@ -0,0 +1,273 @@
+#pragma once
+
+// Hook callback bodies that don't depend on anything Windows-specific.
+// They are templated on the context type so the same code runs on a SafetyHookContext in game
+// and on a Capture::Context when replaying captures with tools/callback_replay.cpp.
+
+#include "memo.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace Callbacks
+{
+    // Aspect ratio values the callbacks read, passed in rather than read from dllmain's globals.
+    struct State
+    {
+        float aspectRatio;
+        float nativeAspect;
+        float aspectMultiplier;
+    };
+
+    inline constexpr float Pi = (float)3.141592653;
+
+    // Fix cropped field of view
+    // The same few FOVs come through every frame, so the atan/tan is only done when the FOV or aspect ratio changes.
+    template<typename Context>
+    void GlobalFOV(Context& ctx, const State& state)
+    {
+        if (state.aspectRatio < state.nativeAspect) {
+            static thread_local Memo::Table<std::array<float, 3>, float> cache{};
+            const float fov = ctx.xmm0.f32[0];
+            ctx.xmm0.f32[0] = cache.Get({ fov, state.aspectRatio, state.nativeAspect }, [&]() {
+                return std::atan(std::tan(fov * Pi / 360.0f) / state.aspectRatio * state.nativeAspect) * 360.0f / Pi;
+                });
+        }
+    }
+
+    // The HUD is laid out on a 3840x2160 canvas. Outside 16:9 it is widened (Horizontal) or heightened (Vertical) to fill
+    // the screen and recentred by an offset along the same axis. The axis is a template parameter, so each instantiation
+    // only contains its own comparison and math.
+    enum class Axis
+    {
+        Horizontal,     // Aspect ratio wider than 16:9
+        Vertical        // Aspect ratio narrower than 16:9
+    };
+
+    template<Axis A>
+    bool Applies(const State& state)
+    {
+        if constexpr (A == Axis::Horizontal)
+            return state.aspectRatio > state.nativeAspect;
+        else
+            return state.aspectRatio < state.nativeAspect;
+    }
+
+    // Canvas size along the axis.
+    template<Axis A>
+    float CanvasSpan(const State& state)
+    {
+        if constexpr (A == Axis::Horizontal)
+            return 2160.00f * state.aspectRatio;
+        else
+            return 3840.00f / state.aspectRatio;
+    }
+
+    // How far the 16:9 area sits from the edge of the canvas along the axis.
+    template<Axis A>
+    float CanvasOffset(const State& state)
+    {
+        if constexpr (A == Axis::Horizontal)
+            return ((2160.00f * state.aspectRatio) - 3840.00f) / 2.00f;
+        else
+            return ((3840.00f / state.aspectRatio) - 2160.00f) / 2.00f;
+    }
+
+    // Byte offset of the axis' component in an x/y float pair.
+    template<Axis A>
+    inline constexpr uintptr_t Component = (A == Axis::Horizontal) ? 0x0 : 0x4;
+
+    template<int N, typename Context>
+    auto& Xmm(Context& ctx)
+    {
+        static_assert(N >= 0 && N < 16);
+        if constexpr (N == 0) return ctx.xmm0;
+        else if constexpr (N == 1) return ctx.xmm1;
+        else if constexpr (N == 2) return ctx.xmm2;
+        else if constexpr (N == 3) return ctx.xmm3;
+        else if constexpr (N == 4) return ctx.xmm4;
+        else if constexpr (N == 5) return ctx.xmm5;
+        else if constexpr (N == 6) return ctx.xmm6;
+        else if constexpr (N == 7) return ctx.xmm7;
+        else if constexpr (N == 8) return ctx.xmm8;
+        else if constexpr (N == 9) return ctx.xmm9;
+        else if constexpr (N == 10) return ctx.xmm10;
+        else if constexpr (N == 11) return ctx.xmm11;
+        else if constexpr (N == 12) return ctx.xmm12;
+        else if constexpr (N == 13) return ctx.xmm13;
+        else if constexpr (N == 14) return ctx.xmm14;
+        else return ctx.xmm15;
+    }
+
+    // Base register for stack (RSP) and struct (RBX, RDI) rectangles.
+    enum class Base
+    {
+        RBX,
+        RSP,
+        RDI
+    };
+
+    template<Base B, typename Context>
+    uintptr_t BaseAddress(const Context& ctx)
+    {
+        if constexpr (B == Base::RBX)
+            return static_cast<uintptr_t>(ctx.rbx);
+        else if constexpr (B == Base::RSP)
+            return static_cast<uintptr_t>(ctx.rsp);
+        else
+            return static_cast<uintptr_t>(ctx.rdi);
+    }
+
+    // Replaces the low float of xmmN with the canvas size, where the game loads 3840 or 2160.
+    template<Axis A, int N, typename Context>
+    void SetSpan(Context& ctx, const State& state)
+    {
+        if (Applies<A>(state))
+            Xmm<N>(ctx).f32[0] = CanvasSpan<A>(state);
+    }
+
+    // Moves a position in the low float of xmmN back by the canvas offset.
+    template<Axis A, int N, typename Context>
+    void SubtractOffset(Context& ctx, const State& state)
+    {
+        if (Applies<A>(state))
+            Xmm<N>(ctx).f32[0] -= CanvasOffset<A>(state);
+    }
+
+    // Used for both HUDOffset and HUDOffsetClip
+    template<typename Context>
+    void HUDOffset(Context& ctx, const State& state)
+    {
+        if (ctx.r12 == 1) {
+            if (Applies<Axis::Horizontal>(state))
+                ctx.xmm0.f32[0] += CanvasOffset<Axis::Horizontal>(state);
+            if (Applies<Axis::Vertical>(state))
+                ctx.xmm0.f32[1] += CanvasOffset<Axis::Vertical>(state);
+        }
+    }
+
+    // Values for a rectangle covering the whole canvas: the origin is moved back by the offset and the extent is the full span.
+    struct Canvas
+    {
+        template<Axis A> static float Origin(const State& state) { return -CanvasOffset<A>(state); }
+        template<Axis A> static float Extent(const State& state) { return CanvasSpan<A>(state); }
+    };
+
+    // A rectangle stored as an x/y origin at base+Origin and an x/y extent at base+Extent.
+    // Values supplies the origin and extent for each axis (see Canvas).
+    template<Base B, uintptr_t Origin, uintptr_t Extent, typename Values, typename Context>
+    void Rect(Context& ctx, const State& state)
+    {
+        const uintptr_t base = BaseAddress<B>(ctx);
+        if (base + Origin) {
+            if (Applies<Axis::Horizontal>(state)) {
+                *reinterpret_cast<float*>(base + Origin + Component<Axis::Horizontal>) = Values::template Origin<Axis::Horizontal>(state);
+                *reinterpret_cast<float*>(base + Extent + Component<Axis::Horizontal>) = Values::template Extent<Axis::Horizontal>(state);
+            }
+            else if (Applies<Axis::Vertical>(state)) {
+                *reinterpret_cast<float*>(base + Origin + Component<Axis::Vertical>) = Values::template Origin<Axis::Vertical>(state);
+                *reinterpret_cast<float*>(base + Extent + Component<Axis::Vertical>) = Values::template Extent<Axis::Vertical>(state);
+            }
+        }
+    }
+
+    // Quads are four x/y vertices 0x20 apart: top left, bottom left, top right, bottom right.
+    inline bool IsCanvasQuad(uintptr_t quad)
+    {
+        return *reinterpret_cast<float*>(quad + 0x40) == 3840.00f && *reinterpret_cast<float*>(quad + 0x24) == 2160.00f;
+    }
+
+    // Stretches a full canvas quad over the widened canvas.
+    template<Axis A>
+    void WidenQuad(uintptr_t quad, const State& state)
+    {
+        // Vertices on the far (right/bottom) and near (left/top) edge along the axis.
+        constexpr uintptr_t Far = (A == Axis::Horizontal) ? 0x40 : 0x20;
+        constexpr uintptr_t Near = (A == Axis::Horizontal) ? 0x20 : 0x40;
+        const float fOffset = CanvasOffset<A>(state);
+        *reinterpret_cast<float*>(quad + Far + Component<A>) = CanvasSpan<A>(state) - fOffset;
+        *reinterpret_cast<float*>(quad + 0x60 + Component<A>) = CanvasSpan<A>(state) - fOffset;
+        *reinterpret_cast<float*>(quad + 0x00 + Component<A>) = -fOffset;
+        *reinterpret_cast<float*>(quad + Near + Component<A>) = -fOffset;
+    }
+
+    // Full screen fades, one quad at rbx+0x40.
+    template<typename Context>
+    void Fades(Context& ctx, const State& state)
+    {
+        if (ctx.rbx + 0x40 && IsCanvasQuad(ctx.rbx + 0x40)) {
+            if (Applies<Axis::Horizontal>(state))
+                WidenQuad<Axis::Horizontal>(ctx.rbx + 0x40, state);
+            else if (Applies<Axis::Vertical>(state))
+                WidenQuad<Axis::Vertical>(ctx.rbx + 0x40, state);
+        }
+    }
+
+    // Reads rdi+0xC0 (APK name), r14+0x10 (element name) and r14+0x20/0x28.
+    template<typename Context>
+    void ElementSize(Context& ctx, const State& state)
+    {
+        if (ctx.r8 + 0x18 && ctx.rdi + 0xC0 && ctx.r14 + 0x10) {
+            // Get name of SpriteStudio 6 APK
+            std::string sAPKName = std::string((char*)ctx.rdi + 0xC0);
+            std::string sElementName = std::string((char*)ctx.r14 + 0x10);
+
+            // Cinematic letterboxing
+            if (sAPKName == "event_face") {
+                if (ctx.xmm14.f32[0] == 1920.00f && (ctx.xmm3.f32[0] == 1898.00f || ctx.xmm3.f32[0] == 262.00f)) {
+                    if (state.aspectRatio > state.nativeAspect) {
+                        ctx.xmm6.f32[0] *= state.aspectMultiplier;
+                    }
+                    else if (state.aspectRatio < state.nativeAspect) {
+                        ctx.xmm5.f32[0] /= state.aspectMultiplier;
+                    }
+                }
+            }
+
+            // Cut-ins
+            if (sAPKName == "common_wipe") {
+                if (sElementName.contains("common_wipe")) {
+                    if (ctx.xmm14.f32[0] == 1920.00f && ctx.xmm3.f32[0] == 1080.00f) {
+                        if (state.aspectRatio > state.nativeAspect) {
+                            ctx.xmm6.f32[0] *= state.aspectMultiplier;
+                        }
+                        else if (state.aspectRatio < state.nativeAspect) {
+                            ctx.xmm5.f32[0] /= state.aspectMultiplier;
+                        }
+                    }
+                }
+            }
+
+            // Turn change wipe
+            if (sAPKName == "mask") {
+                if (*reinterpret_cast<int*>(ctx.r14 + 0x20) == 17 && *reinterpret_cast<int*>(ctx.r14 + 0x28) == 31) {
+                    if (ctx.xmm14.f32[0] == 1920.00f && ctx.xmm3.f32[0] == 1080.00f) {
+                        if (state.aspectRatio > state.nativeAspect) {
+                            ctx.xmm6.f32[0] *= state.aspectMultiplier;
+                        }
+                        else if (state.aspectRatio < state.nativeAspect) {
+                            ctx.xmm5.f32[0] /= state.aspectMultiplier;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Reads and writes rdi+0x90..0x478 (five 0xE0-byte wipe quads).
+    // Quad 0 needs to remain at 16:9, so it is only used to recognise the wipe.
+    template<typename Context>
+    void FadeWipe(Context& ctx, const State& state)
+    {
+        if (ctx.rdi && IsCanvasQuad(ctx.rdi + 0x90)) {
+            for (uintptr_t quad = ctx.rdi + 0x90 + 0xE0; quad <= ctx.rdi + 0x90 + 4 * 0xE0; quad += 0xE0) {
+                if (Applies<Axis::Horizontal>(state))
+                    WidenQuad<Axis::Horizontal>(quad, state);
+                else if (Applies<Axis::Vertical>(state))
+                    WidenQuad<Axis::Vertical>(quad, state);
+            }
+        }
+    }
+}
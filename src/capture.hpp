@@ -0,0 +1,240 @@
+#pragma once
+
+// Hook callback capture.
+// Records the register context and the memory a callback reads, before and after it runs, so the callback can be
+// replayed and benchmarked offline with tools/callback_replay.cpp. The file layout below must stay portable.
+
+#include "callbacks.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <vector>
+#endif
+
+namespace Capture
+{
+    inline constexpr char Magic[8] = { 'M', 'F', 'C', 'A', 'P', 'T', 'R', '\0' };
+    inline constexpr uint32_t Version = 1;
+
+    enum class Hook : uint16_t
+    {
+        GlobalFOV = 0,
+        HUDOffset = 1,
+        HUDOffsetClip = 2,
+        ElementSize = 3,
+        FadeWipe = 4
+    };
+
+    // Same layout as safetyhook::Context64, so either can be copied into the other.
+    union Xmm
+    {
+        uint8_t u8[16];
+        uint16_t u16[8];
+        uint32_t u32[4];
+        uint64_t u64[2];
+        float f32[4];
+        double f64[2];
+    };
+
+    struct Context
+    {
+        Xmm xmm0, xmm1, xmm2, xmm3, xmm4, xmm5, xmm6, xmm7, xmm8, xmm9, xmm10, xmm11, xmm12, xmm13, xmm14, xmm15;
+        uint64_t rflags, r15, r14, r13, r12, r11, r10, r9, r8, rdi, rsi, rdx, rcx, rbx, rax, rbp, rsp, trampoline_rsp, rip;
+    };
+    static_assert(sizeof(Context) == 16 * 16 + 19 * 8);
+
+    enum class Register : uint8_t
+    {
+        RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+        R8, R9, R10, R11, R12, R13, R14, R15
+    };
+
+    template<typename Ctx>
+    auto& Gpr(Ctx& ctx, Register reg)
+    {
+        switch (reg) {
+        case Register::RAX: return ctx.rax;
+        case Register::RCX: return ctx.rcx;
+        case Register::RDX: return ctx.rdx;
+        case Register::RBX: return ctx.rbx;
+        case Register::RSP: return ctx.rsp;
+        case Register::RBP: return ctx.rbp;
+        case Register::RSI: return ctx.rsi;
+        case Register::RDI: return ctx.rdi;
+        case Register::R8: return ctx.r8;
+        case Register::R9: return ctx.r9;
+        case Register::R10: return ctx.r10;
+        case Register::R11: return ctx.r11;
+        case Register::R12: return ctx.r12;
+        case Register::R13: return ctx.r13;
+        case Register::R14: return ctx.r14;
+        default: return ctx.r15;
+        }
+    }
+
+    // Memory at [reg + offset, reg + offset + size) that a callback dereferences. At most one region per register.
+    struct Region
+    {
+        Register reg;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t contextSize;
+    };
+    static_assert(sizeof(FileHeader) == 16);
+
+    // Followed by regionCount RegionHeaders, each followed by size bytes before and size bytes after the callback.
+    struct RecordHeader
+    {
+        uint16_t hook;
+        uint8_t regionCount;
+        uint8_t unreadable;         // Non-zero if a region couldn't be read, so the record can't be replayed
+        uint32_t reserved;
+        Callbacks::State state;
+        uint32_t reserved2;
+        Context before;
+        Context after;
+    };
+    static_assert(sizeof(RecordHeader) == 24 + 2 * sizeof(Context));
+
+    struct RegionHeader
+    {
+        Region region;
+    };
+    static_assert(sizeof(RegionHeader) == 12);
+
+#ifdef _WIN32
+    inline std::atomic<bool> bCapturing{ false };
+    inline uint32_t remaining = 0;
+    inline std::mutex mutex;
+    inline std::ofstream file;
+
+    // Starts capturing. Stops by itself after maxRecords callback invocations.
+    inline bool Open(const std::filesystem::path& path, uint32_t maxRecords)
+    {
+        std::scoped_lock lock(mutex);
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        FileHeader header{};
+        memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.contextSize = sizeof(Context);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        remaining = maxRecords;
+        bCapturing.store(maxRecords != 0, std::memory_order_release);
+        return true;
+    }
+
+    inline bool IsReadable(uintptr_t address, size_t size)
+    {
+        const uintptr_t end = address + size;
+        while (address < end) {
+            MEMORY_BASIC_INFORMATION mbi{};
+            if (!VirtualQuery(reinterpret_cast<void*>(address), &mbi, sizeof(mbi)) || mbi.State != MEM_COMMIT
+                || (mbi.Protect & (PAGE_NOACCESS | PAGE_GUARD)) || mbi.Protect == PAGE_EXECUTE)
+                return false;
+            address = (uintptr_t)mbi.BaseAddress + mbi.RegionSize;
+        }
+        return true;
+    }
+
+    // Captures one callback invocation: construct before the callback runs, the destructor records the result.
+    // Does nothing beyond one atomic load unless capturing. The record is only constructed once capture is on, so the
+    // disabled path doesn't touch it.
+    template<typename Ctx>
+    class Scope
+    {
+    public:
+        static_assert(sizeof(Ctx) == sizeof(Context));
+
+        Scope(Hook hook, Ctx& ctx, std::span<const Region> regions, const Callbacks::State& state)
+            : m_ctx(ctx), m_regions(regions)
+        {
+            if (bCapturing.load(std::memory_order_acquire)) [[unlikely]]
+                Begin(hook, state);
+        }
+
+        ~Scope()
+        {
+            if (m_record) [[unlikely]]
+                End();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Ctx& m_ctx;
+        std::span<const Region> m_regions;
+        std::optional<RecordHeader> m_record{};
+        std::vector<uint8_t> m_before{};
+
+        void Begin(Hook hook, const Callbacks::State& state)
+        {
+            RecordHeader& record = m_record.emplace();
+            record.hook = static_cast<uint16_t>(hook);
+            record.regionCount = static_cast<uint8_t>(m_regions.size());
+            record.state = state;
+            memcpy(&record.before, &m_ctx, sizeof(Context));
+
+            for (const auto& region : m_regions) {
+                const uintptr_t address = Gpr(m_ctx, region.reg) + region.offset;
+                const size_t start = m_before.size();
+                m_before.resize(start + region.size);
+                if (IsReadable(address, region.size))
+                    memcpy(m_before.data() + start, reinterpret_cast<void*>(address), region.size);
+                else
+                    record.unreadable = 1;
+            }
+        }
+
+        void End()
+        {
+            RecordHeader& record = *m_record;
+            memcpy(&record.after, &m_ctx, sizeof(Context));
+
+            std::scoped_lock lock(mutex);
+            if (!remaining)
+                return;
+
+            file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            size_t start = 0;
+            for (const auto& region : m_regions) {
+                const RegionHeader regionHeader = { region };
+                file.write(reinterpret_cast<const char*>(&regionHeader), sizeof(regionHeader));
+                file.write(reinterpret_cast<const char*>(m_before.data() + start), region.size);
+
+                // Regions are read through the register as it was before the callback
+                const uintptr_t address = Gpr(record.before, region.reg) + region.offset;
+                if (!record.unreadable)
+                    file.write(reinterpret_cast<const char*>(address), region.size);
+                else
+                    file.write(reinterpret_cast<const char*>(m_before.data() + start), region.size);
+                start += region.size;
+            }
+
+            if (--remaining == 0) {
+                bCapturing.store(false, std::memory_order_relaxed);
+                file.close();
+            }
+        }
+    };
+#endif
+}
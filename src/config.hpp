@@ -0,0 +1,205 @@
+#pragma once
+
+// Schema-driven ini loader.
+// Settings are declared in one table (section, key, type, default, range, rounding) and the file is parsed in a single pass.
+// The parser itself only works on a string_view and has no Windows dependencies.
+
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <filesystem>
+#endif
+
+namespace Config
+{
+    enum class Type : uint8_t
+    {
+        Bool,
+        Int,
+        Float,
+        AtomicFloat     // For settings that are changed again while the game is running
+    };
+
+    struct Setting
+    {
+        const char* section;
+        const char* key;
+        const char* name;       // Name used in the log
+        Type type;
+        void* value;            // bool*, int*, float* or std::atomic<float>* depending on type
+        double defaultValue;
+        double min = 0;         // No range check if min > max
+        double max = -1;
+        int multiple = 0;       // Round up to a multiple of this (ints only) before range checking
+    };
+
+    enum class Status : uint8_t
+    {
+        Default,    // Key not present, default used
+        Parsed,
+        Clamped,    // Parsed but out of range
+        Invalid     // Present but couldn't be parsed, default used
+    };
+
+    constexpr std::string_view Trim(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t' || text.front() == '\r' || text.front() == '\xEF' || text.front() == '\xBB' || text.front() == '\xBF'))
+            text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r'))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    constexpr bool EqualsNoCase(std::string_view a, std::string_view b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            char x = (a[i] >= 'A' && a[i] <= 'Z') ? a[i] + 32 : a[i];
+            char y = (b[i] >= 'A' && b[i] <= 'Z') ? b[i] + 32 : b[i];
+            if (x != y)
+                return false;
+        }
+        return true;
+    }
+
+    inline void Store(const Setting& setting, double value)
+    {
+        switch (setting.type) {
+        case Type::Bool: *static_cast<bool*>(setting.value) = value != 0; break;
+        case Type::Int: *static_cast<int*>(setting.value) = static_cast<int>(value); break;
+        case Type::Float: *static_cast<float*>(setting.value) = static_cast<float>(value); break;
+        case Type::AtomicFloat: static_cast<std::atomic<float>*>(setting.value)->store(static_cast<float>(value), std::memory_order_relaxed); break;
+        }
+    }
+
+    inline Status ParseValue(const Setting& setting, std::string_view text)
+    {
+        double value = 0;
+        switch (setting.type) {
+        case Type::Bool:
+            if (EqualsNoCase(text, "true") || text == "1")
+                value = 1;
+            else if (EqualsNoCase(text, "false") || text == "0")
+                value = 0;
+            else
+                return Status::Invalid;
+            break;
+        case Type::Int: {
+            int parsed = 0;
+            auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+            if (ec != std::errc() || end != text.data() + text.size())
+                return Status::Invalid;
+            // Rounded in 64 bits so values near INT_MAX don't overflow, and towards +infinity for negative values too.
+            int64_t rounded = parsed;
+            if (setting.multiple > 0) {
+                const int64_t remainder = rounded % setting.multiple;
+                rounded += (remainder > 0) ? setting.multiple - remainder : -remainder;
+                if (rounded > INT32_MAX)
+                    rounded -= setting.multiple;
+            }
+            value = static_cast<double>(rounded);
+            break;
+        }
+        case Type::Float:
+        case Type::AtomicFloat: {
+            float parsed = 0;
+            auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+            if (ec != std::errc() || end != text.data() + text.size() || parsed != parsed)  // NaN passes every range check
+                return Status::Invalid;
+            value = parsed;
+            break;
+        }
+        }
+
+        Status status = Status::Parsed;
+        if (setting.min <= setting.max && (value < setting.min || value > setting.max)) {
+            value = value < setting.min ? setting.min : setting.max;
+            status = Status::Clamped;
+        }
+        Store(setting, value);
+        return status;
+    }
+
+    // Applies defaults, then parses the ini text in one pass. Returns the status of each setting, in schema order.
+    // Later duplicates of a key win, and anything after ';' or '#' is a comment.
+    inline std::vector<Status> Load(std::string_view text, std::span<const Setting> schema)
+    {
+        std::vector<Status> statuses(schema.size(), Status::Default);
+        for (const auto& setting : schema)
+            Store(setting, setting.defaultValue);
+
+        std::string_view section{};
+        while (!text.empty()) {
+            size_t lineEnd = text.find('\n');
+            std::string_view line = text.substr(0, lineEnd);
+            text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+
+            if (size_t comment = line.find_first_of(";#"); comment != std::string_view::npos)
+                line = line.substr(0, comment);
+            line = Trim(line);
+            if (line.empty())
+                continue;
+
+            if (line.front() == '[') {
+                size_t close = line.find(']');
+                section = Trim(line.substr(1, close == std::string_view::npos ? std::string_view::npos : close - 1));
+                continue;
+            }
+
+            size_t equals = line.find('=');
+            if (equals == std::string_view::npos)
+                continue;
+            std::string_view key = Trim(line.substr(0, equals));
+            std::string_view value = Trim(line.substr(equals + 1));
+
+            for (size_t i = 0; i < schema.size(); ++i) {
+                if (section == schema[i].section && key == schema[i].key) {
+                    statuses[i] = ParseValue(schema[i], value);
+                    if (statuses[i] == Status::Invalid)
+                        Store(schema[i], schema[i].defaultValue);
+                    break;
+                }
+            }
+        }
+        return statuses;
+    }
+
+#ifdef _WIN32
+    // Maps the file read-only and loads it. Returns false if the file couldn't be opened.
+    inline bool LoadFile(const std::filesystem::path& path, std::span<const Setting> schema, std::vector<Status>& statuses)
+    {
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize{};
+        GetFileSizeEx(file, &fileSize);
+        if (fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            statuses = Load({}, schema);
+            return true;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view)
+            return false;
+
+        statuses = Load(std::string_view(static_cast<const char*>(view), static_cast<size_t>(fileSize.QuadPart)), schema);
+        UnmapViewOfFile(view);
+        return true;
+    }
+#endif
+}
@@ -1,10 +1,26 @@
 #include "stdafx.h"
 #include "helper.hpp"
 
-#include <inipp/inipp.h>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/base_sink.h>
 #include <safetyhook.hpp>
+#include <d3d11.h>
+
+#include "benchmark.hpp"
+#include "callbacks.hpp"
+#include "capture.hpp"
+#include "config.hpp"
+#include "functions.hpp"
+#include "hooks.hpp"
+#include "hooklog.hpp"
+#include "input.hpp"
+#include "latency.hpp"
+#include "settings.hpp"
+#include "signatures.hpp"
+#include "telemetry.hpp"
+#include "threads.hpp"
+#include "trace.hpp"
+#include "xref.hpp"
 
 HMODULE baseModule = GetModuleHandle(NULL);
 HMODULE thisModule; // Fix DLL
@@ -21,36 +37,14 @@ std::string sExeName;
 std::filesystem::path sThisModulePath;
 
 // Ini
-inipp::Ini<char> ini;
 std::string sConfigFile = sFixName + ".ini";
 std::pair DesktopDimensions = { 0,0 };
 
-// Ini variables
-bool bFixResolution;
-bool bFixAspect;
-bool bFixFOV;
-bool bFixHUD;
-bool bFixMovies;
-bool bSkipLogos;
-bool bSkipMovie;
-bool bMenuFPSCap;
-float fAOResolutionScale = 1.00f;
-float fGameplayFOVMulti = 1.00f;
-float fLODDistance = 10.00f;
-bool bFixAnalog;
-float fCustomResScale = 1.00f;
-bool bDisableOutlines;
-int iShadowResolution = 2048;
-bool bForceControllerIcons;
-bool bDisableCameraShake;
-bool bGameWindow;
-bool bPauseOnFocusLoss;
-
 // Aspect ratio + HUD stuff
-float fPi = (float)3.141592653;
 float fAspectRatio;
 float fNativeAspect = (float)16 / 9;
 float fAspectMultiplier;
+bool bAspectAboveNative;
 float fHUDWidth;
 float fHUDHeight;
 float fHUDWidthOffset;
@@ -63,12 +57,57 @@ int iCurrentResX;
 int iCurrentResY;
 int iResScaleOption = 4;
 uintptr_t LODDistanceAddr;
+std::atomic<float> fRealLODDistance{ 0.00f };     // Read directly by the foliage distance stub
+static_assert(std::atomic<float>::is_always_lock_free && sizeof(std::atomic<float>) == sizeof(float));
+Memory::SignatureCache SigCache;
+
+// Constant patches
+Hooks::ConstantPatch ScreenPosHorPatch;
+Hooks::ConstantPatch ScreenPosVertPatch;
+
+void UpdateConstantPatches()
+{
+    // Slots hold the game's original constant unless the aspect ratio needs it changed.
+    if (ScreenPosHorPatch)
+        ScreenPosHorPatch.Set(fAspectRatio > fNativeAspect ? 2160.00f * fAspectRatio : ScreenPosHorPatch.Original());
+    if (ScreenPosVertPatch)
+        ScreenPosVertPatch.Set(fAspectRatio < fNativeAspect ? 3840.00f / fAspectRatio : ScreenPosVertPatch.Original());
+}
+
+Callbacks::State AspectState()
+{
+    return { fAspectRatio, fNativeAspect, fAspectMultiplier };
+}
+
+// Mid hook for a Callbacks:: template that only needs the aspect state, so a new site is one line:
+//   Hooks::CreateMid(site, AspectHook<Callbacks::SetSpan<Callbacks::Axis::Horizontal, 0, SafetyHookContext>>);
+template<auto Callback>
+void AspectHook(SafetyHookContext& ctx)
+{
+    Callback(ctx, AspectState());
+}
+
+// HUDOffset and HUDOffsetClip run the same callback and are only told apart in captures.
+template<Capture::Hook Hook>
+void HUDOffsetHook(SafetyHookContext& ctx)
+{
+    Capture::Scope capture(Hook, ctx, {}, AspectState());
+    Callbacks::HUDOffset(ctx, AspectState());
+}
+
+// Rectangle values for Callbacks::Rect that cover the 16:9 HUD area in screen pixels, used for movies.
+struct HUDRect
+{
+    template<Callbacks::Axis A> static float Origin(const Callbacks::State&) { return (A == Callbacks::Axis::Horizontal) ? fHUDWidthOffset : fHUDHeightOffset; }
+    template<Callbacks::Axis A> static float Extent(const Callbacks::State&) { return (A == Callbacks::Axis::Horizontal) ? fHUDWidth : fHUDHeight; }
+};
 
 void CalculateAspectRatio(bool bLog)
 {
     // Calculate aspect ratio
     fAspectRatio = (float)iCurrentResX / (float)iCurrentResY;
     fAspectMultiplier = fAspectRatio / fNativeAspect;
+    bAspectAboveNative = fAspectRatio > fNativeAspect;
 
     // HUD variables
     fHUDWidth = iCurrentResY * fNativeAspect;
@@ -82,6 +121,8 @@ void CalculateAspectRatio(bool bLog)
         fHUDHeightOffset = (float)(iCurrentResY - fHUDHeight) / 2;
     }
 
+    UpdateConstantPatches();
+
     if (bLog) {
         // Log details about current resolution
         spdlog::info("----------");
@@ -96,6 +137,66 @@ void CalculateAspectRatio(bool bLog)
     }   
 }
 
+const XRef::Index& CodeXRefs()
+{
+    // Built on first use, then cached to disk keyed by module timestamp.
+    static XRef::Index index{};
+    static bool bBuilt = [] {
+        Timeline::Span span("XRef Build", "scan");
+        auto start = std::chrono::steady_clock::now();
+        bool bResult = index.Build(baseModule, sThisModulePath / (sFixName + ".xref"));
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        if (bResult)
+            spdlog::info("XRef: {} {} references ({:.1f}MB) in {}ms.", index.Loaded() ? "Loaded" : "Indexed", index.Size(), index.Bytes() / 1048576.0, elapsed);
+        else
+            spdlog::error("XRef: Failed to locate code section.");
+        return bResult;
+        }();
+    return index;
+}
+
+const Functions::Index& CodeFunctions()
+{
+    static Functions::Index index{};
+    static bool bBuilt = [] {
+        Timeline::Span span("Function Index Build", "scan");
+        auto start = std::chrono::steady_clock::now();
+        bool bResult = index.Build(baseModule);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        if (bResult)
+            spdlog::info("Functions: Indexed {} functions in {}us.", index.Size(), elapsed);
+        else
+            spdlog::warn("Functions: No exception directory, hook sites won't be checked.");
+        return bResult;
+        }();
+    return index;
+}
+
+// Checks that a hook site found at an offset from a scan result is still inside the scan result's function.
+// Passes if the scan result isn't in an indexed function (leaf functions have no .pdata entry), since there is nothing to check against.
+bool HookSiteInFunction(const char* sName, uintptr_t anchor, uintptr_t site)
+{
+    const auto& functions = CodeFunctions();
+    if (!functions.Find(anchor) || functions.SameFunction(anchor, site))
+        return true;
+
+    spdlog::error("{}: Hook site {:s}+{:x} is outside the function containing {:s}+{:x}, skipping.", sName,
+        sExeName.c_str(), site - (uintptr_t)baseModule, sExeName.c_str(), anchor - (uintptr_t)baseModule);
+    return false;
+}
+
+// Checks that an address taken from a call is the start of a function.
+bool IsFunctionEntry(const char* sName, uintptr_t address)
+{
+    const Functions::Function* function = CodeFunctions().Find(address);
+    if (!function || function->begin == address)
+        return true;
+
+    spdlog::error("{}: {:s}+{:x} is not the start of a function (nearest is {:s}+{:x}), skipping.", sName,
+        sExeName.c_str(), address - (uintptr_t)baseModule, sExeName.c_str(), function->begin - (uintptr_t)baseModule);
+    return false;
+}
+
 // Spdlog sink (truncate on startup, single file)
 template<typename Mutex>
 class size_limited_sink : public spdlog::sinks::base_sink<Mutex> {
@@ -189,8 +290,8 @@ void Logging()
 void Configuration()
 {
     // Initialise config
-    std::ifstream iniFile(sThisModulePath.string() + sConfigFile);
-    if (!iniFile) {
+    std::vector<Config::Status> configStatus{};
+    if (!Config::LoadFile(sThisModulePath / sConfigFile, ConfigSchema, configStatus)) {
         AllocConsole();
         FILE* dummy;
         freopen_s(&dummy, "CONOUT$", "w", stdout);
@@ -201,130 +302,177 @@ void Configuration()
     }
     else {
         spdlog::info("Config file: {}", sThisModulePath.string() + sConfigFile);
-        ini.parse(iniFile);
     }
 
     // Parse config
-    ini.strip_trailing_comments();
     spdlog::info("----------");
+    for (size_t i = 0; i < std::size(ConfigSchema); ++i) {
+        const auto& setting = ConfigSchema[i];
+        std::string value{};
+        switch (setting.type) {
+        case Config::Type::Bool: value = fmt::format("{}", *static_cast<bool*>(setting.value)); break;
+        case Config::Type::Int: value = fmt::format("{}", *static_cast<int*>(setting.value)); break;
+        case Config::Type::Float: value = fmt::format("{}", *static_cast<float*>(setting.value)); break;
+        case Config::Type::AtomicFloat: value = fmt::format("{}", static_cast<std::atomic<float>*>(setting.value)->load()); break;
+        }
 
-    inipp::get_value(ini.sections["Fix Resolution"], "Enabled", bFixResolution);
-    spdlog::info("Config Parse: bFixResolution: {}", bFixResolution);
-
-    inipp::get_value(ini.sections["Fix Aspect Ratio"], "Enabled", bFixAspect);
-    spdlog::info("Config Parse: bFixAspect: {}", bFixAspect);
-
-    inipp::get_value(ini.sections["Fix FOV"], "Enabled", bFixFOV);
-    spdlog::info("Config Parse: bFixFOV: {}", bFixFOV);
-
-    inipp::get_value(ini.sections["Fix HUD"], "Enabled", bFixHUD);
-    spdlog::info("Config Parse: bFixHUD: {}", bFixHUD);
-
-    inipp::get_value(ini.sections["Fix Movies"], "Enabled", bFixMovies);
-    spdlog::info("Config Parse: bFixMovies: {}", bFixMovies);
-
-    inipp::get_value(ini.sections["Intro Skip"], "SkipLogos", bSkipLogos);
-    inipp::get_value(ini.sections["Intro Skip"], "SkipMovie", bSkipMovie);
-    spdlog::info("Config Parse: bSkipLogos: {}", bSkipLogos);
-    spdlog::info("Config Parse: bSkipMovie: {}", bSkipMovie);
+        if (configStatus[i] == Config::Status::Clamped)
+            spdlog::warn("Config Parse: {} value invalid, clamped to {}", setting.name, value);
+        else if (configStatus[i] == Config::Status::Invalid)
+            spdlog::warn("Config Parse: {} value could not be read, using default {}", setting.name, value);
+        spdlog::info("Config Parse: {}: {}", setting.name, value);
+    }
 
-    inipp::get_value(ini.sections["Disable Menu FPS Cap"], "Enabled", bMenuFPSCap);
-    spdlog::info("Config Parse: bMenuFPSCap: {}", bMenuFPSCap);
+    spdlog::info("----------");
 
-    inipp::get_value(ini.sections["Fix Analog Movement"], "Enabled", bFixAnalog);
-    spdlog::info("Config Parse: bFixAnalog: {}", bFixAnalog);
+    // Grab desktop resolution/aspect
+    DesktopDimensions = Util::GetPhysicalDesktopDimensions();
+    iCurrentResX = DesktopDimensions.first;
+    iCurrentResY = DesktopDimensions.second;
+    CalculateAspectRatio(true);
 
-    inipp::get_value(ini.sections["Gameplay FOV"], "Multiplier", fGameplayFOVMulti);
-    if (fGameplayFOVMulti < 0.10f || fGameplayFOVMulti > 3.00f) {
-        fGameplayFOVMulti = std::clamp(fGameplayFOVMulti, 0.10f, 3.00f);
-        spdlog::warn("Config Parse: fGameplayFOVMulti value invalid, clamped to {}", fGameplayFOVMulti);
-    }
-    spdlog::info("Config Parse: fGameplayFOVMulti: {}", fGameplayFOVMulti);
-    
-    inipp::get_value(ini.sections["Ambient Occlusion"], "Resolution", fAOResolutionScale);
-    if (fAOResolutionScale < 0.10f || fAOResolutionScale > 1.00f) {
-        fAOResolutionScale = std::clamp(fAOResolutionScale, 0.10f, 1.00f);
-        spdlog::warn("Config Parse: fAOResolutionScale value invalid, clamped to {}", fAOResolutionScale);
-    }
-    spdlog::info("Config Parse: fAOResolutionScale: {}", fAOResolutionScale);
+    // Spans have been recorded since startup, stop here unless the timeline was asked for.
+    Timeline::bEnabled.store(bStartupTimeline, std::memory_order_relaxed);
 
-    inipp::get_value(ini.sections["LOD"], "Distance", fLODDistance);
-    if (fLODDistance < 1.00f || fLODDistance > 100.00f) {
-        fLODDistance = std::clamp(fLODDistance, 1.00f, 100.00f);
-        spdlog::warn("Config Parse: fLODDistance value invalid, clamped to {}", fLODDistance);
+    if (bTrace) {
+        if (Trace::Open(sThisModulePath / (sFixName + ".trace"), 1 << 16))
+            spdlog::info("Trace: Writing binary trace to {}", (sThisModulePath / (sFixName + ".trace")).string());
+        else
+            spdlog::error("Trace: Failed to create trace file.");
     }
-    spdlog::info("Config Parse: fLODDistance: {}", fLODDistance);
+    Trace::bCountHits = Trace::header || bTelemetry;
 
-    inipp::get_value(ini.sections["Custom Resolution Scale"], "Resolution", fCustomResScale);
-    if (fCustomResScale < 0.10f || fCustomResScale > 4.00f) {
-        fCustomResScale = std::clamp(fCustomResScale, 0.10f, 4.00f);
-        spdlog::warn("Config Parse: fCustomResScale value invalid, clamped to {}", fCustomResScale);
+    if (bCapture) {
+        if (Capture::Open(sThisModulePath / (sFixName + ".capture"), static_cast<uint32_t>(iCaptureCalls)))
+            spdlog::info("Capture: Recording {} callback(s) to {}", iCaptureCalls, (sThisModulePath / (sFixName + ".capture")).string());
+        else
+            spdlog::error("Capture: Failed to create capture file.");
     }
-    spdlog::info("Config Parse: fCustomResScale: {}", fCustomResScale);
+}
 
-    inipp::get_value(ini.sections["Disable Outlines"], "Enabled", bDisableOutlines);
-    spdlog::info("Config Parse: bDisableOutlines: {}", bDisableOutlines);
+// In-game resolution scale option (0 = 200% ... 6 = 50%) to a scale factor. A custom resolution scale takes priority.
+float GetResolutionScale(int option)
+{
+    static constexpr float fScales[] = { 2.00f, 1.75f, 1.50f, 1.25f, 1.00f, 0.75f, 0.50f };
+    const float fCustom = fCustomResScale.load(std::memory_order_relaxed);
+    if (fCustom != 1.00f)
+        return fCustom;
+    return (option >= 0 && option < (int)std::size(fScales)) ? fScales[option] : 1.00f;
+}
 
-    inipp::get_value(ini.sections["Shadow Quality"], "Resolution", iShadowResolution);
-    iShadowResolution = ((iShadowResolution + 63) / 64) * 64;
-    if (iShadowResolution < 64 || iShadowResolution > 16384) {
-        iShadowResolution = std::clamp(iShadowResolution, 64, 16384);
-        spdlog::warn("Config Parse: iShadowResolution value invalid, clamped to {}", iShadowResolution);
-    }
-    spdlog::info("Config Parse: iShadowResolution: {}", iShadowResolution);
+// Render passes whose render target can be sized independently of the main resolution.
+// Each is hooked where the pass's render target size is loaded, with the width and height in two registers.
+// To add a pass: add its signature to signatures.hpp, a scale global with a schema entry, and an entry here.
+struct ScaledPass
+{
+    const char* name;
+    const char* signature;
+    uintptr_t SafetyHookContext::* width;
+    uintptr_t SafetyHookContext::* height;
+    const std::atomic<float>* scale;
+    Trace::Hook traceHook;
+};
 
-    inipp::get_value(ini.sections["Force Controller Icons"], "Enabled", bForceControllerIcons);
-    spdlog::info("Config Parse: bForceControllerIcons: {}", bForceControllerIcons);
+constexpr ScaledPass ScaledPasses[] = {
+    { "Ambient Occlusion", Signatures::AOResolution, &SafetyHookContext::rbx, &SafetyHookContext::rax, &fAOResolutionScale, Trace::Hook::AOResolution },
+};
 
-    inipp::get_value(ini.sections["Disable Camera Shake"], "Enabled", bDisableCameraShake);
-    spdlog::info("Config Parse: bDisableCameraShake: {}", bDisableCameraShake);
+// Last size each pass was given, for telemetry.
+std::atomic<int> iScaledPassResX[std::size(ScaledPasses)]{};
+std::atomic<int> iScaledPassResY[std::size(ScaledPasses)]{};
 
-    inipp::get_value(ini.sections["Game Window"], "Enabled", bGameWindow);
-    spdlog::info("Config Parse: bGameWindow: {}", bGameWindow);
-    inipp::get_value(ini.sections["Game Window"], "PauseOnFocusLoss", bPauseOnFocusLoss);
-    spdlog::info("Config Parse: bPauseOnFocusLoss: {}", bPauseOnFocusLoss);
+template<size_t Index>
+void ScaledPassHook(SafetyHookContext& ctx)
+{
+    constexpr const ScaledPass& pass = ScaledPasses[Index];
+    Trace::HookHit(pass.traceHook);
+
+    // The hook stays installed for benchmark profiles, leave the game's size alone while it wouldn't change anything,
+    // or before the resolution hook has seen a resolution.
+    const float fPassScale = pass.scale->load(std::memory_order_relaxed);
+    if (fPassScale == 1.00f || iCurrentResX == 0 || iCurrentResY == 0)
+        return;
+
+    // Calculate resolution with in-game resolution scale
+    float fResScale = GetResolutionScale(iResScaleOption);
+    int iScaledResX = static_cast<int>(iCurrentResX * fResScale);
+    int iScaledResY = static_cast<int>(iCurrentResY * fResScale);
+
+    // Calculate new pass resolution
+    int iPassResX = static_cast<int>(iScaledResX * fPassScale);
+    int iPassResY = static_cast<int>(iScaledResY * fPassScale);
+
+    // Log old and new resolution
+    HOOKLOG_INFO("{}: Previous Resolution: {}x{}.", pass.name, iScaledResX, iScaledResY);
+    HOOKLOG_INFO("{}: New Resolution: {}x{}.", pass.name, iPassResX, iPassResY);
+
+    // Apply new resolution
+    ctx.*pass.width = iPassResX;
+    ctx.*pass.height = iPassResY;
+    iScaledPassResX[Index].store(iPassResX, std::memory_order_relaxed);
+    iScaledPassResY[Index].store(iPassResY, std::memory_order_relaxed);
+}
 
-    spdlog::info("----------");
+template<size_t Index>
+void InstallScaledPass()
+{
+    const ScaledPass& pass = ScaledPasses[Index];
+    // Benchmark profiles can change the scale later, so the hook is needed even at 1.
+    if (pass.scale->load(std::memory_order_relaxed) == 1.00f && !bBenchmark)
+        return;
+
+    uint8_t* PassScanResult = SigCache.Scan(baseModule, pass.signature);
+    if (PassScanResult) {
+        spdlog::info("{} Resolution: Address is {:s}+{:x} (scaled pass {}, x{})", pass.name, sExeName.c_str(), (uintptr_t)PassScanResult - (uintptr_t)baseModule, Index, pass.scale->load(std::memory_order_relaxed));
+        static SafetyHookMid PassMidHook{};
+        PassMidHook = Hooks::CreateMid(PassScanResult, ScaledPassHook<Index>);
+    }
+    else if (!PassScanResult) {
+        spdlog::error("{} Resolution: Pattern scan failed.", pass.name);
+    }
+}
 
-    // Grab desktop resolution/aspect
-    DesktopDimensions = Util::GetPhysicalDesktopDimensions();
-    iCurrentResX = DesktopDimensions.first;
-    iCurrentResY = DesktopDimensions.second;
-    CalculateAspectRatio(true);
+template<size_t... Indices>
+void InstallScaledPasses(std::index_sequence<Indices...>)
+{
+    (InstallScaledPass<Indices>(), ...);
 }
 
 void Graphics()
 {
+    Hooks::ArenaScope arena("Graphics");
     if (iShadowResolution != 2048) {
         // Shadow Resolution
-        uint8_t* ShadowResolutionScanResult = Memory::PatternScan(baseModule, "C7 ?? ?? 00 08 00 00 C7 ?? ?? 00 08 00 00 C7 ?? ?? ?? ?? ?? ?? C7 ?? ?? 01 00 00 00");
-        uint8_t* ShadowTexShiftScanResult = Memory::PatternScan(baseModule, "41 ?? ?? 48 ?? ?? ?? 48 ?? ?? FF ?? ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ?? 4C ?? ?? ?? ??");
-        uint8_t* CSMSplitsScanResult = Memory::PatternScan(baseModule, "8B ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? ?? C4 ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? 48 ?? ?? ??");
+        uint8_t* ShadowResolutionScanResult = SigCache.Scan(baseModule, Signatures::ShadowResolution);
+        uint8_t* ShadowTexShiftScanResult = SigCache.Scan(baseModule, Signatures::ShadowTexShift);
+        uint8_t* CSMSplitsScanResult = SigCache.Scan(baseModule, Signatures::CSMSplits);
         if (ShadowResolutionScanResult && ShadowTexShiftScanResult && CSMSplitsScanResult) {
             // Set shadowmap resolution
             spdlog::info("Shadow Quality: Resolution: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ShadowResolutionScanResult - (uintptr_t)baseModule);
-            Memory::Write((uintptr_t)ShadowResolutionScanResult + 0x3, iShadowResolution);
-            Memory::Write((uintptr_t)ShadowResolutionScanResult + 0xA, iShadowResolution);
+            Memory::PatchTransaction ShadowResolutionPatch;
+            ShadowResolutionPatch.Write((uintptr_t)ShadowResolutionScanResult + 0x3, iShadowResolution);
+            ShadowResolutionPatch.Write((uintptr_t)ShadowResolutionScanResult + 0xA, iShadowResolution);
+            ShadowResolutionPatch.Commit();
             spdlog::info("Shadow Quality: Resolution: Patched instruction.");
 
             // Set shadowTexShift property to account for increased/decreased shadowmap resolution
             spdlog::info("Shadow Quality: ShadowTexShift: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ShadowTexShiftScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid ShadowTexShiftMidHook{};
-            ShadowTexShiftMidHook = safetyhook::create_mid(ShadowTexShiftScanResult,
-                [](SafetyHookContext& ctx) {
-                    // Default = 1.00f / 2048 (0.00048828125f)
-                    // If this isn't adjusted then shadows can look offset and artifacty
-                    ctx.xmm3.f32[0] = (float)1.00f / iShadowResolution;
-                });
+            // Default = 1.00f / 2048 (0.00048828125f)
+            // If this isn't adjusted then shadows can look offset and artifacty
+            static float fShadowTexShift = (float)1.00f / iShadowResolution;
+            static Hooks::RegisterLoadHook ShadowTexShiftHook{};
+            ShadowTexShiftHook = Hooks::RegisterLoadHook::Create(ShadowTexShiftScanResult, Hooks::Register::XMM3, &fShadowTexShift);
 
             if (iShadowResolution > 2048) {
                 // Adjust CSM split distances
                 // TODO: Is this the right way of scaling CSM split distances? Should they even be adjusted?
                 spdlog::info("Shadow Quality: CSM Splits: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)CSMSplitsScanResult - (uintptr_t)baseModule);
+                // Shadow resolution only changes on restart, so the multiplier is worked out once.
+                static const float fCSMSplitsMulti = 1 + std::log((float)iShadowResolution / 2048.00f);
                 static SafetyHookMid CSMSplitsMidHook{};
-                CSMSplitsMidHook = safetyhook::create_mid(CSMSplitsScanResult,
+                CSMSplitsMidHook = Hooks::CreateMid(CSMSplitsScanResult,
                     [](SafetyHookContext& ctx) {
-                        ctx.xmm12.f32[0] = ctx.xmm12.f32[0] * (1 + std::log((float)iShadowResolution / 2048.00f));
+                        ctx.xmm12.f32[0] = ctx.xmm12.f32[0] * fCSMSplitsMulti;
                     });
             }
         }
@@ -334,25 +482,28 @@ void Graphics()
     }
 
     // Resolution Scale
-    uint8_t* ResolutionScaleScanResult = Memory::PatternScan(baseModule, "8B ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? 44 ?? ?? ??");
+    uint8_t* ResolutionScaleScanResult = SigCache.Scan(baseModule, Signatures::ResolutionScale);
     if (ResolutionScaleScanResult) {
         spdlog::info("Resolution Scale: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ResolutionScaleScanResult - (uintptr_t)baseModule);
         static SafetyHookMid ResolutionScaleMidHook{};
-        ResolutionScaleMidHook = safetyhook::create_mid(ResolutionScaleScanResult + 0xE,
+        ResolutionScaleMidHook = Hooks::CreateMid(ResolutionScaleScanResult + 0xE,
             [](SafetyHookContext& ctx) {
+                Trace::HookHit(Trace::Hook::ResolutionScale);
+
                 // Set custom resolution scale
-                if (fCustomResScale != 1.00f && ctx.rcx + 0x888) {
+                const float fCustom = fCustomResScale.load(std::memory_order_relaxed);
+                if (fCustom != 1.00f && ctx.rcx + 0x888) {
                     // Set res scale option to 4 (100%)
                     *reinterpret_cast<int*>(ctx.rcx + 0x888) = 4;
                     ctx.rax = 4;
                     // Write new resolution scale
-                    Memory::Write(ctx.rdx + 0x10, 1.00f / fCustomResScale);
+                    Memory::Store(ctx.rdx + 0x10, 1.00f / fCustom);
 
-                    spdlog::info("Resolution Scale: Custom: Base Resolution: {}x{}.", iCurrentResX, iCurrentResY);
-                    spdlog::info("Resolution Scale: Custom: Scaled Resolution: {}x{}.", static_cast<int>(iCurrentResX * fCustomResScale), static_cast<int>(iCurrentResY * fCustomResScale));
+                    HOOKLOG_INFO("Resolution Scale: Custom: Base Resolution: {}x{}.", iCurrentResX, iCurrentResY);
+                    HOOKLOG_INFO("Resolution Scale: Custom: Scaled Resolution: {}x{}.", static_cast<int>(iCurrentResX * fCustom), static_cast<int>(iCurrentResY * fCustom));
                 }
 
-                // Log res scale option for AO
+                // Log res scale option for scaled passes
                 iResScaleOption = (int)ctx.rax;
             });
     }
@@ -360,87 +511,40 @@ void Graphics()
         spdlog::error("Resolution Scale: Pattern scan failed.");
     }
 
-    if (fAOResolutionScale != 1.00f) {
-        // Ambient Occlusion Resolution
-        uint8_t* AOResolutionScanResult = Memory::PatternScan(baseModule, "8B ?? 48 ?? ?? ?? ?? ?? ?? 48 ?? ?? 74 ?? E8 ?? ?? ?? ?? 41 ?? 00 40 00 00 41 ?? 16 00 00 00");
-        if (AOResolutionScanResult) {
-            spdlog::info("Ambient Occlusion Resolution: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)AOResolutionScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid AOResolutionMidHook{};
-            AOResolutionMidHook = safetyhook::create_mid(AOResolutionScanResult,
-                [](SafetyHookContext& ctx) {
-                    float fResScale = 1.00f;
-                    switch (iResScaleOption) {
-                    case 0:
-                        fResScale = 2.00f;  // 200%
-                        break;
-                    case 1:
-                        fResScale = 1.75f;  // 175%
-                        break;
-                    case 2:
-                        fResScale = 1.50f;  // 150%
-                        break;
-                    case 3:
-                        fResScale = 1.25f;  // 125%
-                        break;
-                    case 4:
-                        fResScale = 1.00f;  // 100%
-                        break;
-                    case 5:
-                        fResScale = 0.75f;  // 75%
-                        break;
-                    case 6:
-                        fResScale = 0.50f;  // 50%
-                        break;
-                    default:
-                        fResScale = 1.00f;
-                        break;
-                    }
-
-                    if (fCustomResScale != 1.00f)
-                        fResScale = fCustomResScale;
+    // Per-pass render target scaling
+    InstallScaledPasses(std::make_index_sequence<std::size(ScaledPasses)>{});
 
-                    // Calculate resolution with in-game resolution scale
-                    int iScaledResX = static_cast<int>(iCurrentResX * fResScale);
-                    int iScaledResY = static_cast<int>(iCurrentResY * fResScale);
-
-                    // Calculate new ambient occlusion resolution
-                    int iAmbientOcclusionResX = static_cast<int>(iScaledResX * fAOResolutionScale);
-                    int iAmbientOcclusionResY = static_cast<int>(iScaledResY * fAOResolutionScale);
-
-                    // Log old and new resolution
-                    spdlog::info("Ambient Occlusion: Previous Resolution: {}x{}.", iScaledResX, iScaledResY);
-                    spdlog::info("Ambient Occlusion: New Resolution: {}x{}.", iAmbientOcclusionResX, iAmbientOcclusionResY);
-
-                    // Apply new resolution
-                    ctx.rbx = iAmbientOcclusionResX;
-                    ctx.rax = iAmbientOcclusionResY;
-                });
-        }
-        else if (!AOResolutionScanResult) {
-            spdlog::error("Ambient Occlusion Resolution: Pattern scan failed.");
-        }
-    }
-
-    if (fLODDistance != 10.00f) {
+    if (fLODDistance.load(std::memory_order_relaxed) != 10.00f || bBenchmark) {
         // LOD Distance
-        uint8_t* LODDistanceScanResult = Memory::PatternScan(baseModule, "C5 ?? ?? ?? ?? ?? ? ?? C5 ?? ?? ?? ?? ?? 73 ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? 72 ?? C5 ?? ?? ?? ?? 73 ??");
-        uint8_t* FoliageDistanceScanResult = Memory::PatternScan(baseModule, "C5 ?? ?? ?? 73 ?? C5 ?? ?? ?? EB ?? C5 ?? ?? ?? ?? ?? ?? ?? EB ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? 77 ??");
+        uint8_t* LODDistanceScanResult = SigCache.Scan(baseModule, Signatures::LODDistance);
+        uint8_t* FoliageDistanceScanResult = SigCache.Scan(baseModule, Signatures::FoliageDistance);
         if (LODDistanceScanResult && FoliageDistanceScanResult) {
             spdlog::info("LOD: Distance: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)LODDistanceScanResult - (uintptr_t)baseModule);
             LODDistanceAddr = Memory::GetAbsolute((uintptr_t)LODDistanceScanResult + 0x4);
             spdlog::info("LOD: Distance: Value address is {:s}+{:x}", sExeName.c_str(), LODDistanceAddr - (uintptr_t)baseModule);
 
             // Big number scary
-            static float fRealLODDistance = fLODDistance * 1000.00f;
-            // This value can be modified directly since it's only accessed by one function. 
-            Memory::Write(LODDistanceAddr, fRealLODDistance);
+            fRealLODDistance.store(fLODDistance.load(std::memory_order_relaxed) * 1000.00f, std::memory_order_relaxed);
+
+            // This value can be modified directly as long as it's only accessed by one function, so check that before writing it.
+            // If the index couldn't be built there's nothing to check against, so it's written as it always was.
+            const auto& xrefs = CodeXRefs();
+            auto LODDistanceReaders = xrefs.Sources(LODDistanceAddr, XRef::Kind::Data);
+            spdlog::info("LOD: Distance: Value is referenced by {} instruction(s).", LODDistanceReaders.size());
+            if (LODDistanceReaders.size() > 1) {
+                spdlog::error("LOD: Distance: Value is referenced from more than one place, not writing it since other code would be affected.");
+                LODDistanceAddr = 0;    // Keeps benchmark profiles from writing it too
+            }
+            else {
+                if (xrefs.Size() == 0)
+                    spdlog::warn("LOD: Distance: No cross-reference index, writing the value without checking its readers.");
+                Memory::Write(LODDistanceAddr, fRealLODDistance.load(std::memory_order_relaxed));
+            }
 
             spdlog::info("LOD: Foliage: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)FoliageDistanceScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid FoliageDistanceMidHook{};
-            FoliageDistanceMidHook = safetyhook::create_mid(FoliageDistanceScanResult,
-                [](SafetyHookContext& ctx) {
-                    ctx.xmm0.f32[0] = fRealLODDistance; // Default is 5000
-                });
+            // Default is 5000
+            static Hooks::RegisterLoadHook FoliageDistanceHook{};
+            FoliageDistanceHook = Hooks::RegisterLoadHook::Create(FoliageDistanceScanResult, Hooks::Register::XMM0, &fRealLODDistance);
         }
         else if (!LODDistanceScanResult || !FoliageDistanceScanResult) {
             spdlog::error("LOD: Pattern scan(s) failed.");
@@ -449,7 +553,7 @@ void Graphics()
 
     if (bDisableOutlines) {
         // Outline Shader
-        uint8_t* OutlineShaderScanResult = Memory::PatternScan(baseModule, "C7 ?? ?? ?? ?? ?? 0F 00 00 00 C6 ?? ?? ?? ?? ?? 01 C6 ?? ?? ?? ?? ?? 01");
+        uint8_t* OutlineShaderScanResult = SigCache.Scan(baseModule, Signatures::OutlineShader);
         if (OutlineShaderScanResult) {
             spdlog::info("Outline Shader: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)OutlineShaderScanResult - (uintptr_t)baseModule);
             Memory::PatchBytes((uintptr_t)OutlineShaderScanResult + 0x10, "\x00", 1);
@@ -462,14 +566,24 @@ void Graphics()
 }
 
 WNDPROC OldWndProc;
+void BenchmarkHotkey(WPARAM key);
+void SaveArenaHits();
+
 LRESULT __stdcall NewWndProc(HWND window, UINT message_type, WPARAM w_param, LPARAM l_param) {
     switch (message_type) {
+    case WM_KEYDOWN:
+        if (bBenchmark && !(l_param & (1 << 30))) // Ignore auto-repeat
+            BenchmarkHotkey(w_param);
+        break;
+
     case WM_ACTIVATE:
-        if (!bPauseOnFocusLoss && LOWORD(w_param) == WA_INACTIVE)
+        if (bGameWindow && !bPauseOnFocusLoss && LOWORD(w_param) == WA_INACTIVE)
             return 0; // Disable pause on focus loss.
         break;
 
     case WM_SYSCOMMAND:
+        if (!bGameWindow)
+            break;
         switch (w_param) {
             case SC_SCREENSAVE: // Disable screensaver/monitor sleep
             case SC_MONITORPOWER: {
@@ -481,6 +595,10 @@ LRESULT __stdcall NewWndProc(HWND window, UINT message_type, WPARAM w_param, LPA
 
     case WM_CLOSE:
         return DefWindowProc(window, message_type, w_param, l_param); // Return default WndProc
+
+    case WM_DESTROY:
+        SaveArenaHits(); // The game is closing, and unlike DLL_PROCESS_DETACH this isn't under the loader lock.
+        break;
     }
 
     // Return old WndProc
@@ -509,13 +627,14 @@ LONG_PTR WINAPI SetWindowLongPtrW_hk(HWND hWnd, int nIndex, LONG_PTR dwNewLong)
 
 void WindowManagement()
 {
-    if (bGameWindow) {
+    // The benchmark hotkeys are handled in the same WndProc.
+    if (bGameWindow || bBenchmark) {
         // Hook SetWindowLongPtrW
         HMODULE user32Module = GetModuleHandleW(L"user32.dll");
         if (user32Module) {
             FARPROC SetWindowLongPtrW_fn = GetProcAddress(user32Module, "SetWindowLongPtrW");
             if (SetWindowLongPtrW_fn) {
-                SetWindowLongPtrW_sh = safetyhook::create_inline(SetWindowLongPtrW_fn, reinterpret_cast<void*>(SetWindowLongPtrW_hk));
+                SetWindowLongPtrW_sh = Hooks::CreateInline(SetWindowLongPtrW_fn, reinterpret_cast<void*>(SetWindowLongPtrW_hk));
                 spdlog::info("Game Window: Hooked SetWindowLongPtrW.");
             }
             else {
@@ -530,17 +649,18 @@ void WindowManagement()
 
 void IntroSkip()
 {
+    Hooks::ArenaScope arena("IntroSkip");
     if (bSkipLogos || bSkipMovie) {
         // Intro Skip
-        uint8_t* IntroSkipScanResult = Memory::PatternScan(baseModule, "83 ?? ?? 0F 87 ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ?? 8B ?? ?? ?? ?? ?? ?? 48 ?? ?? FF ?? BA 01 00 00 00 48 ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ??");
+        uint8_t* IntroSkipScanResult = SigCache.Scan(baseModule, Signatures::IntroSkip);
         if (IntroSkipScanResult) {
-            static uint8_t* DemoIntroSkipScanResult = Memory::PatternScan(baseModule, "83 ?? 49 0F 87 ?? ?? ?? ?? 48 8D ?? ?? ?? ?? ?? 8B ?? ?? ?? ?? ?? ?? 48 ?? ??");
+            static uint8_t* DemoIntroSkipScanResult = SigCache.Scan(baseModule, Signatures::DemoIntroSkip);
 
             spdlog::info("Intro Skip: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)IntroSkipScanResult - (uintptr_t)baseModule);
             static bool bHasSkippedIntro = false;
 
             static SafetyHookMid IntroSkipMidHook{};
-            IntroSkipMidHook = safetyhook::create_mid(IntroSkipScanResult,
+            IntroSkipMidHook = Hooks::CreateMid(IntroSkipScanResult,
                 [](SafetyHookContext& ctx) {
                     // Title States (Demo)                          // Title States (Full Game)
                     // 0x11 - 0x1E = OOBE                           // 0x0 - 0x2F = OOBE
@@ -552,7 +672,14 @@ void IntroSkip()
                     // 0x36 = Opening movie                         // 0x43 = Press Any Key
                     // 0x3A = Demo message
                     // 0x3F = Main menu
-                    
+
+                    Trace::HookHit(Trace::Hook::IntroSkip);
+                    static int iLastTitleState = -1;
+                    if ((int)ctx.rax != iLastTitleState) {
+                        Trace::Write(Trace::Event::TitleStateChanged, (uint64_t)iLastTitleState, ctx.rax);
+                        iLastTitleState = (int)ctx.rax;
+                    }
+
                     if (!bHasSkippedIntro) {
                         const bool isDemo = (DemoIntroSkipScanResult != nullptr);
                         int iTitleState = (int)ctx.rax;
@@ -593,18 +720,24 @@ void IntroSkip()
 
 void Resolution()
 {
+    Hooks::ArenaScope arena("Resolution");
     // Get current resolution and fix scaling to 16:9
     uint8_t* CurrentResolutionScanResult = nullptr;
-    for (int attempts = 0; attempts < 1000; ++attempts) {
-        if (CurrentResolutionScanResult = Memory::PatternScan(baseModule, "4C ?? ?? ?? ?? ?? ?? ?? 8B ?? 48 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? 8D ?? ?? C1 ?? 04"))
-            break;
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
-    uint8_t* ResolutionFixScanResult = Memory::PatternScan(baseModule, "C5 ?? ?? ?? 89 ?? ?? ?? ?? ?? C5 ?? ?? ?? 89 ?? ?? ?? ?? ?? 85 ?? 7E ??");
+    Timeline::Run("Resolution wait", [&]() {
+        for (int attempts = 0; attempts < 1000; ++attempts) {
+            // While the code at the known/predicted address doesn't match yet, only do a full scan once a second.
+            if (!SigCache.Pending(baseModule, Signatures::CurrentResolution) || attempts % 20 == 0) {
+                if (CurrentResolutionScanResult = SigCache.Scan(baseModule, Signatures::CurrentResolution))
+                    break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        });
+    uint8_t* ResolutionFixScanResult = SigCache.Scan(baseModule, Signatures::ResolutionFix);
     if (CurrentResolutionScanResult && ResolutionFixScanResult) {
         spdlog::info("Resolution: Current: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)CurrentResolutionScanResult - (uintptr_t)baseModule);
         static SafetyHookMid CurrentResolutionMidHook{};
-        CurrentResolutionMidHook = safetyhook::create_mid(CurrentResolutionScanResult,
+        CurrentResolutionMidHook = Hooks::CreateMid(CurrentResolutionScanResult,
             [](SafetyHookContext& ctx) {
                 // Store resolution, before scaling to 16:9 happens.
                 iPreResScaleX = (int)ctx.rax;
@@ -613,8 +746,10 @@ void Resolution()
 
         spdlog::info("Resolution: Fix: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ResolutionFixScanResult - (uintptr_t)baseModule);
         static SafetyHookMid ResolutionFixMidHook{};
-        ResolutionFixMidHook = safetyhook::create_mid(ResolutionFixScanResult,
+        ResolutionFixMidHook = Hooks::CreateMid(ResolutionFixScanResult,
             [](SafetyHookContext& ctx) {
+                Trace::HookHit(Trace::Hook::ResolutionFix);
+
                 // Undo scaling to 16:9
                 if (bFixResolution) {
                     ctx.xmm7.f32[0] = (float)iPreResScaleX;
@@ -628,7 +763,10 @@ void Resolution()
                 if (iResX != iCurrentResX || iResY != iCurrentResY) {
                     iCurrentResX = iResX;
                     iCurrentResY = iResY;
-                    CalculateAspectRatio(true);
+                    CalculateAspectRatio(false);
+                    Trace::Write(Trace::Event::ResolutionChanged, iCurrentResX, iCurrentResY);
+                    HOOKLOG_INFO("Current Resolution: Resolution: {}x{}, fAspectRatio: {}, fAspectMultiplier: {}", iCurrentResX, iCurrentResY, fAspectRatio, fAspectMultiplier);
+                    HOOKLOG_INFO("Current Resolution: fHUDWidth: {}, fHUDHeight: {}, fHUDWidthOffset: {}, fHUDHeightOffset: {}", fHUDWidth, fHUDHeight, fHUDWidthOffset, fHUDHeightOffset);
                 }
             });
     }
@@ -639,31 +777,25 @@ void Resolution()
 
 void AspectRatioFOV()
 {
+    Hooks::ArenaScope arena("AspectRatioFOV");
     if (bFixAspect) {
         // Shadow Aspect Ratio
-        uint8_t* ShadowAspectRatioScanResult = Memory::PatternScan(baseModule, "48 ?? ?? ?? C5 ?? ?? ?? ?? ?? E8 ?? ?? ?? ?? 8B ?? ?? ?? ?? ?? 4C ?? ?? ?? ?? ??");
+        uint8_t* ShadowAspectRatioScanResult = SigCache.Scan(baseModule, Signatures::ShadowAspectRatio);
         if (ShadowAspectRatioScanResult) {
             spdlog::info("Aspect Ratio: Shadows: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ShadowAspectRatioScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid ShadowAspectRatioMidHook{};
-            ShadowAspectRatioMidHook = safetyhook::create_mid(ShadowAspectRatioScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio > fNativeAspect)
-                        ctx.xmm1.f32[0] = fAspectRatio;
-                });
+            static Hooks::RegisterLoadHook ShadowAspectRatioHook{};
+            ShadowAspectRatioHook = Hooks::RegisterLoadHook::Create(ShadowAspectRatioScanResult, Hooks::Register::XMM1, &fAspectRatio, &bAspectAboveNative);
         }
         else if (!ShadowAspectRatioScanResult) {
             spdlog::error("Aspect Ratio: Shadows: Pattern scan failed.");
         }
 
         // CameraPane Aspect Ratio
-        uint8_t* CameraPaneAspectRatioScanResult = Memory::PatternScan(baseModule, "48 ?? ?? E8 ?? ?? ?? ?? C5 ?? ?? ?? ?? 48 ?? ?? E8 ?? ?? ?? ?? C5 ?? ?? ?? ?? 48 ?? ?? E8 ?? ?? ?? ?? 4C ?? ??");
+        uint8_t* CameraPaneAspectRatioScanResult = SigCache.Scan(baseModule, Signatures::CameraPaneAspectRatio);
         if (CameraPaneAspectRatioScanResult) {
             spdlog::info("Aspect Ratio: CameraPane: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)CameraPaneAspectRatioScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid CameraPaneAspectRatioMidHook{};
-            CameraPaneAspectRatioMidHook = safetyhook::create_mid(CameraPaneAspectRatioScanResult,
-                [](SafetyHookContext& ctx) {
-                    ctx.xmm1.f32[0] = fNativeAspect;
-                });
+            static Hooks::RegisterLoadHook CameraPaneAspectRatioHook{};
+            CameraPaneAspectRatioHook = Hooks::RegisterLoadHook::Create(CameraPaneAspectRatioScanResult, Hooks::Register::XMM1, &fNativeAspect);
         }
         else if (!CameraPaneAspectRatioScanResult) {
             spdlog::error("Aspect Ratio: CameraPane: Pattern scan failed.");
@@ -672,15 +804,14 @@ void AspectRatioFOV()
 
     if (bFixFOV) {
         // Global FOV
-        uint8_t* GlobalFOVScanResult = Memory::PatternScan(baseModule, "E9 ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? E8 ?? ?? ?? ?? C5 ?? ?? ??");
+        uint8_t* GlobalFOVScanResult = SigCache.Scan(baseModule, Signatures::GlobalFOV);
         if (GlobalFOVScanResult) {
             spdlog::info("FOV: Global: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)GlobalFOVScanResult - (uintptr_t)baseModule);
             static SafetyHookMid GlobalFOVMidHook{};
-            GlobalFOVMidHook = safetyhook::create_mid(GlobalFOVScanResult + 0xD,
+            GlobalFOVMidHook = Hooks::CreateMid(GlobalFOVScanResult + 0xD,
                 [](SafetyHookContext& ctx) {
-                    // Fix cropped field of view
-                    if (fAspectRatio < fNativeAspect)
-                        ctx.xmm0.f32[0] = atan(tan(ctx.xmm0.f32[0] * fPi / 360.0f) / fAspectRatio * fNativeAspect) * 360.0f / fPi;
+                    Capture::Scope capture(Capture::Hook::GlobalFOV, ctx, {}, AspectState());
+                    Callbacks::GlobalFOV(ctx, AspectState());
                 });
         }
         else if (!GlobalFOVScanResult) {
@@ -690,17 +821,19 @@ void AspectRatioFOV()
     
     if (fGameplayFOVMulti != 1.00f) {
         // Gameplay FOV
-        uint8_t* GameplayFOVScanResult = Memory::PatternScan(baseModule, "45 ?? ?? 48 ?? ?? C4 ?? ?? ?? ?? E8 ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? C4 ?? ?? ?? ?? C5 ?? ?? ??");
+        uint8_t* GameplayFOVScanResult = SigCache.Scan(baseModule, Signatures::GameplayFOV);
         if (GameplayFOVScanResult) {
             spdlog::info("FOV: Gameplay: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)GameplayFOVScanResult - (uintptr_t)baseModule);
             uintptr_t GameplayFOVFunctionAddr = Memory::GetAbsolute((uintptr_t)GameplayFOVScanResult + 0xC);
             spdlog::info("FOV: Gameplay: Function address is {:s}+{:x}", sExeName.c_str(), GameplayFOVFunctionAddr - (uintptr_t)baseModule);
-            static SafetyHookMid GameplayFOVMidHook{};
-            GameplayFOVMidHook = safetyhook::create_mid(GameplayFOVFunctionAddr,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rax != 0)
-                        ctx.xmm1.f32[0] *= fGameplayFOVMulti;
-                });
+            if (IsFunctionEntry("FOV: Gameplay", GameplayFOVFunctionAddr)) {
+                static SafetyHookMid GameplayFOVMidHook{};
+                GameplayFOVMidHook = Hooks::CreateMid(GameplayFOVFunctionAddr,
+                    [](SafetyHookContext& ctx) {
+                        if (ctx.rax != 0)
+                            ctx.xmm1.f32[0] *= fGameplayFOVMulti;
+                    });
+            }
         }
         else if (!GameplayFOVScanResult) {
             spdlog::error("FOV: Gameplay: Pattern scan failed.");
@@ -710,20 +843,21 @@ void AspectRatioFOV()
 
 void HUD() 
 {
+    Hooks::ArenaScope arena("HUD");
     if (bFixHUD) {
         // HUD Size
-        uint8_t* HUDWidthScanResult = Memory::PatternScan(baseModule, "F3 0F ?? ?? ?? ?? ?? ?? E8 ?? ?? ?? ?? F3 0F ?? ?? 66 0F ?? ?? 0F ?? ?? F3 0F ?? ??");
+        uint8_t* HUDWidthScanResult = SigCache.Scan(baseModule, Signatures::HUDWidth);
         if (HUDWidthScanResult) {
             spdlog::info("HUD: Size: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDWidthScanResult - (uintptr_t)baseModule);
             static SafetyHookMid HUDWidthMidHook{};
-            HUDWidthMidHook = safetyhook::create_mid(HUDWidthScanResult + 0xD,
+            HUDWidthMidHook = Hooks::CreateMid(HUDWidthScanResult + 0xD,
                 [](SafetyHookContext& ctx) {
                     if (fAspectRatio > fNativeAspect)
                         ctx.xmm6.f32[0] = (float)iCurrentResX / (2160.00f * fAspectRatio);
                 });
 
             static SafetyHookMid HUDHeightMidHook{};
-            HUDHeightMidHook = safetyhook::create_mid(HUDWidthScanResult + 0x24,
+            HUDHeightMidHook = Hooks::CreateMid(HUDWidthScanResult + 0x24,
                 [](SafetyHookContext& ctx) {
                     if (fAspectRatio < fNativeAspect)
                         ctx.xmm0.f32[0] = (float)iCurrentResY / (3840.00f / fAspectRatio);
@@ -734,30 +868,13 @@ void HUD()
         }
 
         // Fades
-        uint8_t* FadesScanResult = Memory::PatternScan(baseModule, "F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? ?? ?? ?? ?? 89 ?? ?? 0F ?? ?? ?? ?? ?? ?? C1 ?? 08");
+        uint8_t* FadesScanResult = SigCache.Scan(baseModule, Signatures::Fades);
         if (FadesScanResult) {
             spdlog::info("HUD: Fades: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)FadesScanResult - (uintptr_t)baseModule);
             static SafetyHookMid FadesMidHook{};
-            FadesMidHook = safetyhook::create_mid(FadesScanResult,
+            FadesMidHook = Hooks::CreateMid(FadesScanResult,
                 [](SafetyHookContext& ctx) {
-                    if (ctx.rbx + 0x40) {
-                        if (*reinterpret_cast<float*>(ctx.rbx + 0x64) == 2160.00f && *reinterpret_cast<float*>(ctx.rbx + 0x80) == 3840.00f) {
-                            if (fAspectRatio > fNativeAspect) {
-                                float fWidthOffset = ((2160.00f * fAspectRatio) - 3840.00f) / 2.00f;
-                                *reinterpret_cast<float*>(ctx.rbx + 0x80) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rbx + 0xA0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rbx + 0x40) = -fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rbx + 0x60) = -fWidthOffset;
-                            }
-                            else if (fAspectRatio < fNativeAspect) {
-                                float fHeightOffset = ((3840.00f / fAspectRatio) - 2160.00f) / 2.00f;
-                                *reinterpret_cast<float*>(ctx.rbx + 0x64) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rbx + 0xA4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rbx + 0x44) = -fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rbx + 0x84) = -fHeightOffset;
-                            }
-                        }
-                    }
+                    Callbacks::Fades(ctx, AspectState());
                 });
         }
         else if (!FadesScanResult) {
@@ -765,22 +882,13 @@ void HUD()
         }
 
         // Pause Screen Capture
-        uint8_t* PauseCaptureScanResult = Memory::PatternScan(baseModule, "48 ?? ?? ?? ?? 48 ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? ?? 5F 5E 5B C3");
+        uint8_t* PauseCaptureScanResult = SigCache.Scan(baseModule, Signatures::PauseCapture);
         if (PauseCaptureScanResult) {
             spdlog::info("HUD: Pause Capture: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)PauseCaptureScanResult - (uintptr_t)baseModule);
             static SafetyHookMid PauseCaptureMidHook{};
-            PauseCaptureMidHook = safetyhook::create_mid(PauseCaptureScanResult + 0xA,
+            PauseCaptureMidHook = Hooks::CreateMid(PauseCaptureScanResult + 0xA,
                 [](SafetyHookContext& ctx) {
-                    if (ctx.rsp + 0x60) {
-                        if (fAspectRatio > fNativeAspect) {
-                            *reinterpret_cast<float*>(ctx.rsp + 0x60) = -(((2160.00f * fAspectRatio) - 3840.00f) / 2.00f);
-                            *reinterpret_cast<float*>(ctx.rsp + 0x70) = 2160.00f * fAspectRatio;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            *reinterpret_cast<float*>(ctx.rsp + 0x64) = -(((3840.00f / fAspectRatio) - 2160.00f) / 2.00f);
-                            *reinterpret_cast<float*>(ctx.rsp + 0x74) = 3840.00f / fAspectRatio;
-                        }
-                    }
+                    Callbacks::Rect<Callbacks::Base::RSP, 0x60, 0x70, Callbacks::Canvas>(ctx, AspectState());
                 });
         }
         else if (!PauseCaptureScanResult) {
@@ -788,127 +896,71 @@ void HUD()
         }
 
         // HUD Offset
-        uint8_t* HUDOffsetScanResult = Memory::PatternScan(baseModule, "F2 0F ?? ?? ?? ?? 0F ?? ?? 0F ?? ?? ?? ?? 45 ?? ?? 74 ?? 48 ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? 48 ?? ?? FF ?? ??");
-        uint8_t* HUDOffsetClipScanResult = Memory::PatternScan(baseModule, "66 0F ?? ?? ?? ?? 0F ?? ?? 0F ?? ?? ?? ?? 45 ?? ?? 74 ?? 48 ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? 48 ?? ?? FF ?? ??");
+        uint8_t* HUDOffsetScanResult = SigCache.Scan(baseModule, Signatures::HUDOffset);
+        uint8_t* HUDOffsetClipScanResult = SigCache.Scan(baseModule, Signatures::HUDOffsetClip);
         if (HUDOffsetScanResult && HUDOffsetClipScanResult) {
             spdlog::info("HUD: Offset: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDOffsetScanResult - (uintptr_t)baseModule);
             static SafetyHookMid HUDOffsetMidHook{};
-            HUDOffsetMidHook = safetyhook::create_mid(HUDOffsetScanResult + 0x9,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.r12 == 1) {
-                        if (fAspectRatio > fNativeAspect)
-                            ctx.xmm0.f32[0] += ((2160.00f * fAspectRatio) - 3840.00f) / 2.00f;
-                        if (fAspectRatio < fNativeAspect)
-                            ctx.xmm0.f32[1] += ((3840.00f / fAspectRatio) - 2160.00f) / 2.00f;
-                    }
-                });
+            HUDOffsetMidHook = Hooks::CreateMid(HUDOffsetScanResult + 0x9, HUDOffsetHook<Capture::Hook::HUDOffset>);
 
             spdlog::info("HUD: Offset: Clipping: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDOffsetClipScanResult - (uintptr_t)baseModule);
             static SafetyHookMid HUDOffsetClipMidHook{};
-            HUDOffsetClipMidHook = safetyhook::create_mid(HUDOffsetClipScanResult + 0x9,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.r12 == 1) {
-                        if (fAspectRatio > fNativeAspect)
-                            ctx.xmm0.f32[0] += ((2160.00f * fAspectRatio) - 3840.00f) / 2.00f;
-                        if (fAspectRatio < fNativeAspect)
-                            ctx.xmm0.f32[1] += ((3840.00f / fAspectRatio) - 2160.00f) / 2.00f;
-                    }
-                });
+            HUDOffsetClipMidHook = Hooks::CreateMid(HUDOffsetClipScanResult + 0x9, HUDOffsetHook<Capture::Hook::HUDOffsetClip>);
         }
         else if (!HUDOffsetScanResult || !HUDOffsetClipScanResult) {
             spdlog::error("HUD: Offset: Pattern scan(s) failed.");
         }
 
         // Screen Position
-        uint8_t* ScreenPosHorScanResult = Memory::PatternScan(baseModule, "C5 ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? 48 8B ?? ?? ?? C5 ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? ?? ??");
-        uint8_t* ScreenPosVertScanResult = Memory::PatternScan(baseModule, "C5 ?? ?? ?? C5 ?? ?? ?? 48 ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ??");
+        uint8_t* ScreenPosHorScanResult = SigCache.Scan(baseModule, Signatures::ScreenPosHor);
+        uint8_t* ScreenPosVertScanResult = SigCache.Scan(baseModule, Signatures::ScreenPosVert);
         if (ScreenPosHorScanResult && ScreenPosVertScanResult) {
             spdlog::info("HUD: ScreenPos: Horizontal: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ScreenPosHorScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid ScreenPosHorMidHook{};
-            ScreenPosHorMidHook = safetyhook::create_mid(ScreenPosHorScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio > fNativeAspect)
-                        ctx.xmm0.f32[0] = 2160.00f * fAspectRatio;
-                });
+            ScreenPosHorPatch = Hooks::ConstantPatch::Create(ScreenPosHorScanResult, Hooks::Register::XMM0, 3840.00f);
+            if (ScreenPosHorPatch) {
+                UpdateConstantPatches();
+                spdlog::info("HUD: ScreenPos: Horizontal: Patched constant load.");
+            }
+            else {
+                static SafetyHookMid ScreenPosHorMidHook{};
+                ScreenPosHorMidHook = Hooks::CreateMid(ScreenPosHorScanResult, AspectHook<Callbacks::SetSpan<Callbacks::Axis::Horizontal, 0, SafetyHookContext>>);
+            }
 
-            static SafetyHookMid ScreenPosHorOffsetMidHook{};
-            ScreenPosHorOffsetMidHook = safetyhook::create_mid(ScreenPosHorScanResult + 0x21,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio > fNativeAspect)
-                        ctx.xmm0.f32[0] -= ((2160.00f * fAspectRatio) - 3840.00f) / 2.00f;
-                });
+            if (HookSiteInFunction("HUD: ScreenPos: Horizontal", (uintptr_t)ScreenPosHorScanResult, (uintptr_t)ScreenPosHorScanResult + 0x21)) {
+                static SafetyHookMid ScreenPosHorOffsetMidHook{};
+                ScreenPosHorOffsetMidHook = Hooks::CreateMid(ScreenPosHorScanResult + 0x21, AspectHook<Callbacks::SubtractOffset<Callbacks::Axis::Horizontal, 0, SafetyHookContext>>);
+            }
 
             spdlog::info("HUD: ScreenPos: Vertical: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ScreenPosVertScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid ScreenPosVertMidHook{};
-            ScreenPosVertMidHook = safetyhook::create_mid(ScreenPosVertScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio < fNativeAspect)
-                        ctx.xmm0.f32[0] = 3840.00f / fAspectRatio;
-                });
+            ScreenPosVertPatch = Hooks::ConstantPatch::Create(ScreenPosVertScanResult, Hooks::Register::XMM0, 2160.00f);
+            if (ScreenPosVertPatch) {
+                UpdateConstantPatches();
+                spdlog::info("HUD: ScreenPos: Vertical: Patched constant load.");
+            }
+            else {
+                static SafetyHookMid ScreenPosVertMidHook{};
+                ScreenPosVertMidHook = Hooks::CreateMid(ScreenPosVertScanResult, AspectHook<Callbacks::SetSpan<Callbacks::Axis::Vertical, 0, SafetyHookContext>>);
+            }
 
-            static SafetyHookMid ScreenPosVertOffsetMidHook{};
-            ScreenPosVertOffsetMidHook = safetyhook::create_mid(ScreenPosHorScanResult + 0x11,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio < fNativeAspect)
-                        ctx.xmm8.f32[0] -= ((3840.00f / fAspectRatio) - 2160.00f) / 2.00f;
-                });
+            if (HookSiteInFunction("HUD: ScreenPos: Vertical", (uintptr_t)ScreenPosHorScanResult, (uintptr_t)ScreenPosHorScanResult + 0x11)) {
+                static SafetyHookMid ScreenPosVertOffsetMidHook{};
+                ScreenPosVertOffsetMidHook = Hooks::CreateMid(ScreenPosHorScanResult + 0x11, AspectHook<Callbacks::SubtractOffset<Callbacks::Axis::Vertical, 8, SafetyHookContext>>);
+            }
         }
         else if (!ScreenPosHorScanResult || !ScreenPosVertScanResult) {
             spdlog::error("HUD: ScreenPos: Pattern scan(s) failed.");
         }
 
         // Adjust individual HUD elements
-        uint8_t* ElementSizeScanResult = Memory::PatternScan(baseModule, "45 ?? ?? 8B ?? ?? 0F ?? ?? ?? ?? 89 ?? ?? 8B ?? ?? ?? 89 ?? ??");
+        uint8_t* ElementSizeScanResult = SigCache.Scan(baseModule, Signatures::ElementSize);
         if (ElementSizeScanResult) {
             spdlog::info("HUD: Element Size: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ElementSizeScanResult - (uintptr_t)baseModule);
             static SafetyHookMid ElementSizeMidHook{};
-            ElementSizeMidHook = safetyhook::create_mid(ElementSizeScanResult + 0x3,
+            ElementSizeMidHook = Hooks::CreateMid(ElementSizeScanResult + 0x3,
                 [](SafetyHookContext& ctx) {
-                    if (ctx.r8 + 0x18 && ctx.rdi + 0xC0 && ctx.r14 + 0x10) {
-                        // Get name of SpriteStudio 6 APK
-                        std::string sAPKName = std::string((char*)ctx.rdi + 0xC0);
-                        std::string sElementName = std::string((char*)ctx.r14 + 0x10);
-
-                        // Cinematic letterboxing
-                        if (sAPKName == "event_face") {
-                            if (ctx.xmm14.f32[0] == 1920.00f && (ctx.xmm3.f32[0] == 1898.00f || ctx.xmm3.f32[0] == 262.00f)) {
-                                if (fAspectRatio > fNativeAspect) {
-                                    ctx.xmm6.f32[0] *= fAspectMultiplier;
-                                }
-                                else if (fAspectRatio < fNativeAspect) {
-                                    ctx.xmm5.f32[0] /= fAspectMultiplier;
-                                }
-                            }
-                        }
-
-                        // Cut-ins
-                        if (sAPKName == "common_wipe") {
-                            if (sElementName.contains("common_wipe")) {
-                                if (ctx.xmm14.f32[0] == 1920.00f && ctx.xmm3.f32[0] == 1080.00f) {
-                                    if (fAspectRatio > fNativeAspect) {
-                                        ctx.xmm6.f32[0] *= fAspectMultiplier;
-                                    }
-                                    else if (fAspectRatio < fNativeAspect) {
-                                        ctx.xmm5.f32[0] /= fAspectMultiplier;
-                                    }
-                                }
-                            }
-                        }
-
-                        // Turn change wipe
-                        if (sAPKName == "mask") {
-                            if (*reinterpret_cast<int*>(ctx.r14 + 0x20) == 17 && *reinterpret_cast<int*>(ctx.r14 + 0x28) == 31) {
-                                if (ctx.xmm14.f32[0] == 1920.00f && ctx.xmm3.f32[0] == 1080.00f) {
-                                    if (fAspectRatio > fNativeAspect) {
-                                        ctx.xmm6.f32[0] *= fAspectMultiplier;
-                                    }
-                                    else if (fAspectRatio < fNativeAspect) {
-                                        ctx.xmm5.f32[0] /= fAspectMultiplier;
-                                    }
-                                }
-                            }
-                        }
-                    }
+                    static constexpr Capture::Region regions[] = { { Capture::Register::RDI, 0xC0, 0x80 }, { Capture::Register::R14, 0x10, 0x40 } };
+                    Capture::Scope capture(Capture::Hook::ElementSize, ctx, regions, AspectState());
+                    Callbacks::ElementSize(ctx, AspectState());
                 });
         }
         else if (!ElementSizeScanResult) {
@@ -916,72 +968,15 @@ void HUD()
         }
 
         // Fade Wipe
-        uint8_t* FadeWipeScanResult = Memory::PatternScan(baseModule, "48 ?? ?? B2 01 48 ?? ?? FF ?? ?? ?? ?? ?? 48 ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ?? 48 ?? ?? 0F 84 ?? ?? ?? ??");
+        uint8_t* FadeWipeScanResult = SigCache.Scan(baseModule, Signatures::FadeWipe);
         if (FadeWipeScanResult) {
             spdlog::info("HUD: Fade Wipe: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)FadeWipeScanResult - (uintptr_t)baseModule);
             static SafetyHookMid FadeWipeMidHook{};
-            FadeWipeMidHook = safetyhook::create_mid(FadeWipeScanResult,
+            FadeWipeMidHook = Hooks::CreateMid(FadeWipeScanResult,
                 [](SafetyHookContext& ctx) {
-                    if (ctx.rdi) {
-                        if (*reinterpret_cast<float*>(ctx.rdi + 0xD0) == 3840.00f && *reinterpret_cast<float*>(ctx.rdi + 0xB4) == 2160.00f) {
-                            if (fAspectRatio > fNativeAspect) {
-                                float fWidthOffset = ((2160.00f * fAspectRatio) - 3840.00f) / 2.00f;
-                                // 0 - This needs to remain at 16:9.
-                                //*reinterpret_cast<float*>(ctx.rdi + 0xD0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                //*reinterpret_cast<float*>(ctx.rdi + 0xF0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                //*reinterpret_cast<float*>(ctx.rdi + 0x90) = -fWidthOffset;
-                                //*reinterpret_cast<float*>(ctx.rdi + 0xB0) = -fWidthOffset;
-                                // 1
-                                *reinterpret_cast<float*>(ctx.rdi + 0xE0 + 0xD0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0xE0 + 0xF0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0xE0 + 0x90) = -fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0xE0 + 0xB0) = -fWidthOffset;
-                                // 2
-                                *reinterpret_cast<float*>(ctx.rdi + 0x1C0 + 0xD0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x1C0 + 0xF0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x1C0 + 0x90) = -fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x1C0 + 0xB0) = -fWidthOffset;
-                                // 3
-                                *reinterpret_cast<float*>(ctx.rdi + 0x2A0 + 0xD0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x2A0 + 0xF0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x2A0 + 0x90) = -fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x2A0 + 0xB0) = -fWidthOffset;
-                                // 4
-                                *reinterpret_cast<float*>(ctx.rdi + 0x380 + 0xD0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x380 + 0xF0) = (2160.00f * fAspectRatio) - fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x380 + 0x90) = -fWidthOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x380 + 0xB0) = -fWidthOffset;
-                            }
-                            else if (fAspectRatio < fNativeAspect) {
-                                float fHeightOffset = ((3840.00f / fAspectRatio) - 2160.00f) / 2.00f;
-                                // 0 - This needs to remain at 16:9.
-                                //*reinterpret_cast<float*>(ctx.rdi + 0xB4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                //*reinterpret_cast<float*>(ctx.rdi + 0xF4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                //*reinterpret_cast<float*>(ctx.rdi + 0x94) = -fHeightOffset;
-                                //*reinterpret_cast<float*>(ctx.rdi + 0xD4) = -fHeightOffset;
-                                // 1
-                                *reinterpret_cast<float*>(ctx.rdi + 0xE0 + 0xB4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0xE0 + 0xF4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0xE0 + 0x94) = -fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0xE0 + 0xD4) = -fHeightOffset;
-                                // 2
-                                *reinterpret_cast<float*>(ctx.rdi + 0x1C0 + 0xB4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x1C0 + 0xF4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x1C0 + 0x94) = -fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x1C0 + 0xD4) = -fHeightOffset;
-                                // 3
-                                *reinterpret_cast<float*>(ctx.rdi + 0x2A0 + 0xB4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x2A0 + 0xF4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x2A0 + 0x94) = -fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x2A0 + 0xD4) = -fHeightOffset;
-                                // 4
-                                *reinterpret_cast<float*>(ctx.rdi + 0x380 + 0xB4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x380 + 0xF4) = (3840.00f / fAspectRatio) - fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x380 + 0x94) = -fHeightOffset;
-                                *reinterpret_cast<float*>(ctx.rdi + 0x380 + 0xD4) = -fHeightOffset;
-                            }
-                        }
-                    }
+                    static constexpr Capture::Region regions[] = { { Capture::Register::RDI, 0x90, 0x3E8 } };
+                    Capture::Scope capture(Capture::Hook::FadeWipe, ctx, regions, AspectState());
+                    Callbacks::FadeWipe(ctx, AspectState());
                 });
         }
         else if (!FadeWipeScanResult) {
@@ -989,22 +984,24 @@ void HUD()
         }
 
         // CameraPane Size
-        uint8_t* CameraPaneScanResult = Memory::PatternScan(baseModule, "41 ?? ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? 41 0F ?? ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? ?? ?? ??");
+        uint8_t* CameraPaneScanResult = SigCache.Scan(baseModule, Signatures::CameraPane);
         if (CameraPaneScanResult) {
             spdlog::info("HUD: CameraPane Size: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)CameraPaneScanResult - (uintptr_t)baseModule);
             static SafetyHookMid CameraPaneWidthMidHook{};
-            CameraPaneWidthMidHook = safetyhook::create_mid(CameraPaneScanResult,
+            CameraPaneWidthMidHook = Hooks::CreateMid(CameraPaneScanResult,
                 [](SafetyHookContext& ctx) {
                     if (fAspectRatio > fNativeAspect)
                         ctx.xmm10.f32[0] = fHUDWidth / 2.00f;
                 });
 
-            static SafetyHookMid CameraPaneHeightMidHook{};
-            CameraPaneHeightMidHook = safetyhook::create_mid(CameraPaneScanResult - 0x13,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio < fNativeAspect)
-                        ctx.xmm4.f32[0] = fHUDHeight / 2.00f;
-                });
+            if (HookSiteInFunction("HUD: CameraPane Size", (uintptr_t)CameraPaneScanResult, (uintptr_t)CameraPaneScanResult - 0x13)) {
+                static SafetyHookMid CameraPaneHeightMidHook{};
+                CameraPaneHeightMidHook = Hooks::CreateMid(CameraPaneScanResult - 0x13,
+                    [](SafetyHookContext& ctx) {
+                        if (fAspectRatio < fNativeAspect)
+                            ctx.xmm4.f32[0] = fHUDHeight / 2.00f;
+                    });
+            }
         }
         else if (!CameraPaneScanResult) {
             spdlog::error("HUD: CameraPane Size: Pattern scan failed.");
@@ -1014,22 +1011,13 @@ void HUD()
     if (bFixMovies) {
         // Movies
         // TPL::movie::MovieSofdecWIN64
-        uint8_t* MoviesScanResult = Memory::PatternScan(baseModule, "8B ?? ?? 48 ?? ?? ?? 48 ?? ?? ?? ?? 4C ?? ?? ?? ?? 4C ?? ?? ?? ?? F3 0F ?? ?? ?? ?? E8 ?? ?? ?? ??");
+        uint8_t* MoviesScanResult = SigCache.Scan(baseModule, Signatures::Movies);
         if (MoviesScanResult) {
             spdlog::info("HUD: Movies: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)MoviesScanResult - (uintptr_t)baseModule);
             static SafetyHookMid MoviesMidHook{};
-            MoviesMidHook = safetyhook::create_mid(MoviesScanResult,
+            MoviesMidHook = Hooks::CreateMid(MoviesScanResult,
                 [](SafetyHookContext& ctx) {
-                    if (ctx.rsp + 0x30) {
-                        if (fAspectRatio > fNativeAspect) {
-                            *reinterpret_cast<float*>(ctx.rsp + 0x30) = fHUDWidthOffset;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x38) = fHUDWidth;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            *reinterpret_cast<float*>(ctx.rsp + 0x34) = fHUDHeightOffset;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x3C) = fHUDHeight;
-                        }
-                    }
+                    Callbacks::Rect<Callbacks::Base::RSP, 0x30, 0x38, HUDRect>(ctx, AspectState());
                 });
         }
         else if (!MoviesScanResult) {
@@ -1040,16 +1028,15 @@ void HUD()
 
 void Misc() 
 {
+    Hooks::ArenaScope arena("Misc");
     if (bMenuFPSCap) {
         // Fix framerate cap. Stops menus being locked to 60fps with vsync off and other odd behaviour.
-        uint8_t* FramerateCapScanResult = Memory::PatternScan(baseModule, "89 ?? ?? ?? ?? ?? 8B ?? C7 ?? ?? ?? ?? ?? ?? ?? 85 ?? 75 ?? 48 ?? ?? ?? ?? ?? ?? 00");
+        uint8_t* FramerateCapScanResult = SigCache.Scan(baseModule, Signatures::FramerateCap);
         if (FramerateCapScanResult) {
             spdlog::info("Framerate Cap: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)FramerateCapScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid FramerateCapMidHook{};
-            FramerateCapMidHook = safetyhook::create_mid(FramerateCapScanResult,
-                [](SafetyHookContext& ctx) {
-                    ctx.rcx = 0;
-                });
+            static const uint64_t iFramerateCap = 0;
+            static Hooks::RegisterLoadHook FramerateCapHook{};
+            FramerateCapHook = Hooks::RegisterLoadHook::Create(FramerateCapScanResult, Hooks::Register::RCX, &iFramerateCap);
         }
         else if (!FramerateCapScanResult) {
             spdlog::error("Framerate Cap: Pattern scan failed.");
@@ -1058,11 +1045,13 @@ void Misc()
 
     if (bFixAnalog) {
         // Fix 8-way analog gating
-        uint8_t* XInputGetStateScanResult = Memory::PatternScan(baseModule, "3D ?? ?? ?? ?? 8D ?? ?? ?? ?? ?? C5 ?? ?? ?? 41 ?? ?? ?? 3D ?? ?? ?? ?? C5 ?? ?? ?? 0F ?? ?? ?? ??");
+        uint8_t* XInputGetStateScanResult = SigCache.Scan(baseModule, Signatures::XInputGetState);
         if (XInputGetStateScanResult) {
             spdlog::info("Analog Movement Fix: XInputGetState: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)XInputGetStateScanResult - (uintptr_t)baseModule);
-            Memory::Write((uintptr_t)XInputGetStateScanResult + 0x55, 0);
-            Memory::Write((uintptr_t)XInputGetStateScanResult + 0x68, 0);
+            Memory::PatchTransaction AnalogPatch;
+            AnalogPatch.Write((uintptr_t)XInputGetStateScanResult + 0x55, 0);
+            AnalogPatch.Write((uintptr_t)XInputGetStateScanResult + 0x68, 0);
+            AnalogPatch.Commit();
             spdlog::info("Analog Movement Fix: XInputGetState: Patched instructions.");
         }
         else if (!XInputGetStateScanResult) {
@@ -1072,18 +1061,21 @@ void Misc()
     
     if (bForceControllerIcons) {
         // Force Controller Icons
-        uint8_t* KeyboardIconsScanResult = Memory::PatternScan(baseModule, "84 ?? 74 ?? C7 ?? ?? ?? ?? ?? 02 00 00 00 48 ?? ?? ?? 5B C3");
-        uint8_t* MouseIcons1ScanResult = Memory::PatternScan(baseModule, "E8 ?? ?? ?? ?? 48 ?? ?? ?? 5B E9 ?? ?? ?? ?? C7 ?? ?? ?? ?? ?? 01 00 00 00 48 ?? ?? ?? 5B C3");
-        uint8_t* MouseIcons2ScanResult = Memory::PatternScan(baseModule, "C7 ?? ?? ?? ?? ?? 01 00 00 00 E8 ?? ?? ?? ?? 83 ?? 01 75 ?? 0F ?? ?? E8 ?? ?? ?? ?? E8 ?? ?? ?? ?? 85 ?? 0F 85 ?? ?? ?? ?? 4C ?? ?? ?? ??");
+        uint8_t* KeyboardIconsScanResult = SigCache.Scan(baseModule, Signatures::KeyboardIcons);
+        uint8_t* MouseIcons1ScanResult = SigCache.Scan(baseModule, Signatures::MouseIcons1);
+        uint8_t* MouseIcons2ScanResult = SigCache.Scan(baseModule, Signatures::MouseIcons2);
         if (KeyboardIconsScanResult && MouseIcons1ScanResult && MouseIcons2ScanResult) {
+            Memory::PatchTransaction ControllerIconsPatch;
             spdlog::info("Force Controller Icons: Keyboard: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)KeyboardIconsScanResult - (uintptr_t)baseModule);
-            Memory::PatchBytes((uintptr_t)KeyboardIconsScanResult + 0xA, "\x00", 1);
+            ControllerIconsPatch.PatchBytes((uintptr_t)KeyboardIconsScanResult + 0xA, "\x00", 1);
 
             spdlog::info("Force Controller Icons: Mouse: 1: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)MouseIcons1ScanResult - (uintptr_t)baseModule);
-            Memory::PatchBytes((uintptr_t)MouseIcons1ScanResult + 0x15, "\x00", 1);
+            ControllerIconsPatch.PatchBytes((uintptr_t)MouseIcons1ScanResult + 0x15, "\x00", 1);
 
             spdlog::info("Force Controller Icons: Mouse: 2: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)MouseIcons2ScanResult - (uintptr_t)baseModule);
-            Memory::PatchBytes((uintptr_t)MouseIcons2ScanResult + 0x6, "\x00", 1);
+            ControllerIconsPatch.PatchBytes((uintptr_t)MouseIcons2ScanResult + 0x6, "\x00", 1);
+
+            spdlog::info("Force Controller Icons: Patched instructions ({} protection changes).", ControllerIconsPatch.Commit());
         }
         else if (!KeyboardIconsScanResult || !MouseIcons1ScanResult || !MouseIcons2ScanResult) {
             spdlog::error("Force Controller Icons: Pattern scan(s) failed.");
@@ -1092,7 +1084,7 @@ void Misc()
 
     if (bDisableCameraShake) {
         // Camera Shake
-        uint8_t* CameraShakeScanResult = Memory::PatternScan(baseModule, "41 ?? ?? 05 44 89 ?? ?? ?? ?? ?? C5 ?? ?? ?? 02");
+        uint8_t* CameraShakeScanResult = SigCache.Scan(baseModule, Signatures::CameraShake);
         if (CameraShakeScanResult) {
             spdlog::info("Camera Shake: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)CameraShakeScanResult - (uintptr_t)baseModule);
             Memory::Write((uintptr_t)CameraShakeScanResult + 0x3, (BYTE)0x04);
@@ -1104,17 +1096,608 @@ void Misc()
     }
 }
 
+// Benchmark
+SettingsProfile BaseSettings{};
+int iActiveProfile = -1;    // -1 = the settings from the main sections
+std::mutex BenchmarkMutex;
+
+struct BenchmarkState
+{
+    Benchmark::Run run;
+    std::vector<size_t> profiles;   // Indices into BenchmarkProfiles, in run order
+};
+std::atomic<BenchmarkState*> pBenchmark{ nullptr };
+std::atomic<bool> bBenchmarkAbort{ false };
+
+// AO and custom resolution scale apply the next time the game sizes its render targets (e.g. when the resolution scale option changes).
+// LOD distance applies straight away. Shadow resolution is patched at startup, so it can't be part of a profile.
+void ApplySettingsProfile(const SettingsProfile& profile)
+{
+    fAOResolutionScale.store(profile.fAOResolutionScale, std::memory_order_relaxed);
+    fCustomResScale.store(profile.fCustomResScale, std::memory_order_relaxed);
+    fLODDistance.store(profile.fLODDistance, std::memory_order_relaxed);
+    fRealLODDistance.store(profile.fLODDistance * 1000.00f, std::memory_order_relaxed);
+    if (LODDistanceAddr)
+        Memory::Write(LODDistanceAddr, profile.fLODDistance * 1000.00f);
+}
+
+void BenchmarkFinished(BenchmarkState* state)
+{
+    std::vector<std::string> names{};
+    for (size_t profile : state->profiles)
+        names.push_back(sBenchmarkProfileNames[profile]);
+
+    std::filesystem::path reportPath = sThisModulePath / (sFixName + ".benchmark.txt");
+    std::ofstream report(reportPath, std::ios::trunc);
+    report << state->run.Report(names);
+    if (report)
+        spdlog::info("Benchmark: Wrote report to {}", reportPath.string());
+    else
+        spdlog::error("Benchmark: Failed to write {}", reportPath.string());
+
+    std::scoped_lock lock(BenchmarkMutex);
+    iActiveProfile = -1;
+    ApplySettingsProfile(BaseSettings);
+    delete state;
+}
+
+void BenchmarkHotkey(WPARAM key)
+{
+    std::scoped_lock lock(BenchmarkMutex);
+    if (key == static_cast<WPARAM>(iBenchmarkProfileKey)) {
+        if (pBenchmark.load(std::memory_order_acquire))
+            return;
+
+        // Cycle through the enabled profiles, then back to the main settings.
+        do {
+            iActiveProfile = (iActiveProfile + 1 < (int)Benchmark::MaxProfiles) ? iActiveProfile + 1 : -1;
+        } while (iActiveProfile != -1 && !BenchmarkProfiles[iActiveProfile].bEnabled);
+
+        ApplySettingsProfile(iActiveProfile == -1 ? BaseSettings : BenchmarkProfiles[iActiveProfile]);
+        spdlog::info("Benchmark: Switched to {}.", iActiveProfile == -1 ? "main settings" : sBenchmarkProfileNames[iActiveProfile]);
+    }
+    else if (key == static_cast<WPARAM>(iBenchmarkRunKey)) {
+        if (pBenchmark.load(std::memory_order_acquire)) {
+            bBenchmarkAbort.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        std::vector<size_t> profiles{};
+        for (size_t i = 0; i < Benchmark::MaxProfiles; ++i) {
+            if (BenchmarkProfiles[i].bEnabled)
+                profiles.push_back(i);
+        }
+        if (profiles.size() < 2) {
+            spdlog::warn("Benchmark: At least two profiles need to be enabled.");
+            return;
+        }
+
+        // A run switches profiles mid-scene, where only LOD distance takes effect, so every segment would measure the same render targets.
+        const SettingsProfile& first = BenchmarkProfiles[profiles[0]];
+        for (size_t profile : profiles) {
+            if (BenchmarkProfiles[profile].fAOResolutionScale != first.fAOResolutionScale || BenchmarkProfiles[profile].fCustomResScale != first.fCustomResScale) {
+                spdlog::error("Benchmark: Enabled profiles differ in AO resolution or custom resolution scale, which only apply when the game recreates its render targets. "
+                    "Compare those with the profile key instead, only LOD distance can differ between profiles in a run.");
+                return;
+            }
+        }
+
+        spdlog::info("Benchmark: Starting, {} profile(s), {} segment(s) each of {}s. Stand still until it finishes.", profiles.size(), iBenchmarkSegments, iBenchmarkSegmentSeconds);
+        bBenchmarkAbort.store(false, std::memory_order_relaxed);
+        pBenchmark.store(new BenchmarkState{ Benchmark::Run(profiles.size(), iBenchmarkSegments, iBenchmarkSegmentSeconds, 2.0), profiles }, std::memory_order_release);
+    }
+}
+
+// Called once per presented frame.
+void FrameTick()
+{
+    BenchmarkState* state = pBenchmark.load(std::memory_order_acquire);
+    if (!state)
+        return;
+
+    if (bBenchmarkAbort.load(std::memory_order_relaxed)) {
+        pBenchmark.store(nullptr, std::memory_order_release);
+        spdlog::info("Benchmark: Stopped.");
+        std::scoped_lock lock(BenchmarkMutex);
+        iActiveProfile = -1;
+        ApplySettingsProfile(BaseSettings);
+        delete state;
+        return;
+    }
+
+    LARGE_INTEGER now{}, frequency{};
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+    switch (state->run.Frame(static_cast<double>(now.QuadPart) / static_cast<double>(frequency.QuadPart))) {
+    case Benchmark::Run::Action::Switch: {
+        std::scoped_lock lock(BenchmarkMutex);
+        ApplySettingsProfile(BenchmarkProfiles[state->profiles[state->run.Profile()]]);
+        break;
+    }
+    case Benchmark::Run::Action::Finished:
+        // The report is written off the render thread.
+        pBenchmark.store(nullptr, std::memory_order_release);
+        std::thread(BenchmarkFinished, state).detach();
+        break;
+    default:
+        break;
+    }
+}
+
+// Latency limiter. Only touched from the thread that presents.
+IDXGISwapChain* pLatencySwapChain = nullptr;
+Latency::GpuSignal LatencySignal;
+std::optional<Latency::Limiter<Latency::GpuSignal, Latency::PerformanceClock>> LatencyLimiter;
+Latency::Summary LatencySummary{};
+double fLatencySummaryStart = -1.0;
+
+// Sets the limiter up for the swap chain being presented. Runs again if the game switches to a new swap chain.
+void LatencySetup(IDXGISwapChain* pSwapChain)
+{
+    pLatencySwapChain = pSwapChain;
+    LatencyLimiter.reset();
+    LatencySignal.Release();
+
+    ID3D11Device* device = nullptr;
+    if (FAILED(pSwapChain->GetDevice(__uuidof(ID3D11Device), reinterpret_cast<void**>(&device))) || !device) {
+        spdlog::warn("Latency Limiter: Swap chain doesn't belong to a D3D11 device, not limiting.");
+        return;
+    }
+
+    if (LatencySignal.Create(device)) {
+        LatencyLimiter.emplace(LatencySignal, Latency::PerformanceClock{}, static_cast<size_t>(iLatencyMaxQueuedFrames));
+
+        // DXGI keeps its own queue of up to 3 frames by default, cap that too.
+        IDXGIDevice1* dxgiDevice = nullptr;
+        if (SUCCEEDED(device->QueryInterface(__uuidof(IDXGIDevice1), reinterpret_cast<void**>(&dxgiDevice))) && dxgiDevice) {
+            dxgiDevice->SetMaximumFrameLatency(static_cast<UINT>(LatencyLimiter->Depth()));
+            dxgiDevice->Release();
+        }
+        spdlog::info("Latency Limiter: Limiting the render queue to {} frame(s), waiting on {}.", LatencyLimiter->Depth(),
+            LatencySignal.UsesFence() ? "a fence" : "event queries");
+    }
+    else {
+        spdlog::error("Latency Limiter: Failed to create a fence or event queries.");
+        LatencySignal.Release();
+    }
+    device->Release();
+}
+
+// Called after each present. Every finished frame goes to the trace, the log gets a summary every few seconds.
+void LatencyTick()
+{
+    const double waited = LatencyLimiter->AfterPresent([](const Latency::Frame& frame) {
+        LatencySummary.Add(frame);
+        Trace::Write(Trace::Event::FrameLatency, static_cast<uint64_t>(frame.simToPresent * 1e6), static_cast<uint64_t>(frame.presentToDone * 1e6));
+        });
+    LatencySummary.waited += waited;
+
+    const double now = Latency::PerformanceClock{}.Now();
+    if (fLatencySummaryStart < 0.0)
+        fLatencySummaryStart = now;
+    if (now - fLatencySummaryStart < 5.0 || !LatencySummary.frames)
+        return;
+
+    const double frames = static_cast<double>(LatencySummary.frames);
+    spdlog::info("Latency Limiter: {} frames, sim to present {:.2f}ms (max {:.2f}ms), present to GPU done {:.2f}ms, waited {:.2f}ms per frame.",
+        LatencySummary.frames, LatencySummary.simToPresent / frames * 1000.0, LatencySummary.simToPresentMax * 1000.0,
+        LatencySummary.presentToDone / frames * 1000.0, LatencySummary.waited / frames * 1000.0);
+    LatencySummary = {};
+    fLatencySummaryStart = now;
+}
+
+// Telemetry
+std::atomic<Telemetry::Block*> pTelemetryBlock{ nullptr };
+
+// Called before each present. Everything is gathered from globals and relaxed counters, so the game's threads never wait on readers.
+void TelemetryTick()
+{
+    Telemetry::Block* pBlock = pTelemetryBlock.load(std::memory_order_acquire);
+    if (!pBlock)
+        return;
+
+    static_assert(Telemetry::HookCount == Trace::HookCount);
+    static Telemetry::Snapshot snapshot = []() {
+        LARGE_INTEGER frequency{};
+        QueryPerformanceFrequency(&frequency);
+        Telemetry::Snapshot initial{};
+        initial.timerFrequency = static_cast<uint64_t>(frequency.QuadPart);
+        return initial;
+        }();
+
+    LARGE_INTEGER now{};
+    QueryPerformanceCounter(&now);
+    snapshot.timestamp = static_cast<uint64_t>(now.QuadPart);
+    ++snapshot.updates;
+    snapshot.resX = iCurrentResX;
+    snapshot.resY = iCurrentResY;
+    snapshot.aspectRatio = fAspectRatio;
+    snapshot.hudWidth = fHUDWidth;
+    snapshot.hudHeight = fHUDHeight;
+    snapshot.resScaleOption = iResScaleOption;
+    snapshot.resScale = GetResolutionScale(iResScaleOption);
+    for (size_t i = 0; i < std::size(ScaledPasses); ++i) {
+        if (ScaledPasses[i].traceHook == Trace::Hook::AOResolution) {
+            snapshot.aoResX = iScaledPassResX[i].load(std::memory_order_relaxed);
+            snapshot.aoResY = iScaledPassResY[i].load(std::memory_order_relaxed);
+        }
+    }
+    snapshot.lodDistance = fLODDistance.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < Trace::HookCount; ++i)
+        snapshot.hookHits[i] = Trace::hits[i].load(std::memory_order_relaxed);
+
+    Telemetry::Publish(*pBlock, snapshot);
+}
+
+SafetyHookInline Present_sh{};
+HRESULT STDMETHODCALLTYPE Present_hk(IDXGISwapChain* pSwapChain, UINT SyncInterval, UINT Flags)
+{
+    if (Flags & DXGI_PRESENT_TEST)
+        return Present_sh.stdcall<HRESULT>(pSwapChain, SyncInterval, Flags);
+
+    FrameTick();
+    TelemetryTick();
+    if (!bLatencyLimiter)
+        return Present_sh.stdcall<HRESULT>(pSwapChain, SyncInterval, Flags);
+
+    if (pSwapChain != pLatencySwapChain)
+        LatencySetup(pSwapChain);
+    if (LatencyLimiter)
+        LatencyLimiter->BeforePresent();
+    HRESULT hr = Present_sh.stdcall<HRESULT>(pSwapChain, SyncInterval, Flags);
+    // Waiting here, rather than before the present, holds back the start of the next frame's simulation.
+    if (LatencyLimiter)
+        LatencyTick();
+    return hr;
+}
+
+void FrameHook()
+{
+    if (!bBenchmark && !bLatencyLimiter && !bTelemetry)
+        return;
+
+    {
+        std::scoped_lock lock(BenchmarkMutex);
+        BaseSettings = { true, fAOResolutionScale.load(), fLODDistance.load(), fCustomResScale.load() };
+    }
+
+    // IDXGISwapChain::Present lives in dxgi.dll and is shared by every swap chain, so a throwaway D3D11 swap chain gives its address.
+    HMODULE d3d11Module = LoadLibraryW(L"d3d11.dll");
+    auto D3D11CreateDeviceAndSwapChain_fn = d3d11Module ? reinterpret_cast<decltype(&D3D11CreateDeviceAndSwapChain)>(GetProcAddress(d3d11Module, "D3D11CreateDeviceAndSwapChain")) : nullptr;
+    if (!D3D11CreateDeviceAndSwapChain_fn) {
+        spdlog::error("Frame Hook: Failed to get function address for D3D11CreateDeviceAndSwapChain.");
+        return;
+    }
+
+    WNDCLASSEXW windowClass{ sizeof(WNDCLASSEXW), CS_CLASSDC, DefWindowProcW, 0, 0, thisModule, nullptr, nullptr, nullptr, nullptr, L"MetaphorFixDummyWindow", nullptr };
+    RegisterClassExW(&windowClass);
+    HWND dummyWindow = CreateWindowExW(0, windowClass.lpszClassName, L"", WS_OVERLAPPEDWINDOW, 0, 0, 64, 64, nullptr, nullptr, thisModule, nullptr);
+
+    DXGI_SWAP_CHAIN_DESC swapChainDesc{};
+    swapChainDesc.BufferCount = 1;
+    swapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapChainDesc.OutputWindow = dummyWindow;
+    swapChainDesc.SampleDesc.Count = 1;
+    swapChainDesc.Windowed = TRUE;
+    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+
+    IDXGISwapChain* swapChain = nullptr;
+    ID3D11Device* device = nullptr;
+    HRESULT hr = D3D11CreateDeviceAndSwapChain_fn(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, &swapChainDesc, &swapChain, &device, nullptr, nullptr);
+    if (SUCCEEDED(hr) && swapChain) {
+        void* Present_fn = (*reinterpret_cast<void***>(swapChain))[8];
+        Present_sh = Hooks::CreateInline(Present_fn, reinterpret_cast<void*>(Present_hk));
+        spdlog::info("Frame Hook: Hooked IDXGISwapChain::Present.");
+    }
+    else {
+        spdlog::error("Frame Hook: Failed to create dummy swap chain ({:#x}).", static_cast<uint32_t>(hr));
+    }
+
+    if (swapChain)
+        swapChain->Release();
+    if (device)
+        device->Release();
+    DestroyWindow(dummyWindow);
+    UnregisterClassW(windowClass.lpszClassName, thisModule);
+}
+
+// Input polling
+SafetyHookInline XInputGetState_sh{};
+struct XInputDevice
+{
+    uint32_t GetState(uint32_t index, Input::Pad& pad) { return XInputGetState_sh.stdcall<DWORD>(static_cast<DWORD>(index), &pad); }
+};
+XInputDevice InputDevice;
+Input::Poller<XInputDevice> InputPoller{ InputDevice };
+std::atomic<bool> bInputPollingActive{ false };
+std::atomic<uint32_t> iInputPollingThreadId{ 0 };
+
+DWORD WINAPI XInputGetState_hk(DWORD dwUserIndex, Input::Pad* pState)
+{
+    // Fall through to the device until the polling thread has published every pad once.
+    if (!bInputPollingActive.load(std::memory_order_acquire) || dwUserIndex >= Input::MaxPads || !pState)
+        return XInputGetState_sh.stdcall<DWORD>(dwUserIndex, pState);
+
+    Input::Pad pad{};
+    DWORD dwResult = InputPoller.mailboxes[dwUserIndex].Read(pad);
+    if (dwResult == ERROR_SUCCESS)
+        *pState = pad;
+    return dwResult;
+}
+
+void InputPolling()
+{
+    if (!bInputPolling)
+        return;
+
+    // Hook whichever XInput the game has loaded.
+    HMODULE xinputModule = nullptr;
+    for (const wchar_t* sModule : { L"xinput1_4.dll", L"xinput1_3.dll", L"xinput9_1_0.dll" }) {
+        xinputModule = GetModuleHandleW(sModule);
+        if (xinputModule)
+            break;
+    }
+    if (!xinputModule)
+        xinputModule = LoadLibraryW(L"xinput1_4.dll");
+    if (!xinputModule) {
+        spdlog::error("Input Polling: Failed to get module handle for XInput.");
+        return;
+    }
+
+    FARPROC XInputGetState_fn = GetProcAddress(xinputModule, "XInputGetState");
+    if (!XInputGetState_fn) {
+        spdlog::error("Input Polling: Failed to get function address for XInputGetState.");
+        return;
+    }
+    XInputGetState_sh = Hooks::CreateInline(XInputGetState_fn, reinterpret_cast<void*>(XInputGetState_hk));
+    spdlog::info("Input Polling: Hooked XInputGetState, polling at {}Hz.", iInputPollingRate);
+
+    std::thread poller([]() {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+
+        // High resolution waitable timers need Windows 10 1803. Sleep(1) is the fallback, which caps the rate at around 1000Hz.
+        HANDLE hTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!hTimer)
+            spdlog::warn("Input Polling: High resolution timer unavailable, falling back to Sleep.");
+
+        const Input::FilterSettings settings = { iInputDeadzone, fInputSmoothing };
+        const uint32_t iReconnectInterval = static_cast<uint32_t>(iInputPollingRate);     // Empty slots are retried once a second
+        LARGE_INTEGER dueTime{};
+        dueTime.QuadPart = -10000000LL / iInputPollingRate;                                 // Relative, in 100ns units
+
+        InputPoller.Step(settings, iReconnectInterval);
+        bInputPollingActive.store(true, std::memory_order_release);
+        for (;;) {
+            if (hTimer && SetWaitableTimer(hTimer, &dueTime, 0, nullptr, nullptr, FALSE))
+                WaitForSingleObject(hTimer, INFINITE);
+            else
+                Sleep(1);
+            InputPoller.Step(settings, iReconnectInterval);
+        }
+        });
+
+    // Stored from here rather than by the thread itself so ThreadScheduling, which runs after us, can't see the poller before its ID is set.
+    iInputPollingThreadId.store(GetThreadId(poller.native_handle()), std::memory_order_relaxed);
+    poller.detach();
+}
+
+// Main is a fix thread too, and gets the fix role's cores and priority as soon as they're loaded rather than running the hook
+// installs ahead of the game's own startup threads.
+void ScheduleInitThread()
+{
+    if (!bThreadScheduling)
+        return;
+
+    const Threads::Topology topology = Threads::QueryTopology();
+    const auto cores = static_cast<Threads::Cores>(iFixCores);
+    const uint64_t mask = (cores == Threads::Cores::Any) ? 0 : topology.Mask(cores);
+    const bool bApplied = Threads::Apply(GetCurrentThreadId(), mask, iFixPriority);
+    spdlog::info("Thread Scheduling: Init thread {}: cores {:#x}, priority {:+}{}", GetCurrentThreadId(), mask, iFixPriority, bApplied ? "" : " (failed)");
+}
+
+void ThreadScheduling()
+{
+    if (!bThreadScheduling)
+        return;
+
+    // The game keeps creating threads after the hooks are in, so look for new ones every few seconds for the first minute.
+    // Called from Main, which ScheduleInitThread has already moved, so it's skipped rather than having the priority offset applied twice.
+    std::thread([initThreadId = GetCurrentThreadId()]() {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+
+        Threads::Topology topology = Threads::QueryTopology();
+        spdlog::info("Thread Scheduling: {} core(s), hybrid: {}, performance cores: {:#x}, efficiency cores: {:#x}", topology.cores.size(), topology.IsHybrid(),
+            topology.Mask(Threads::Cores::Performance), topology.Mask(Threads::Cores::Efficiency));
+
+        const int* pCores[] = { nullptr, &iMainCores, &iRenderCores, &iAudioCores, &iWorkerCores, &iFixCores };
+        const int* pPriorities[] = { nullptr, &iMainPriority, &iRenderPriority, &iAudioPriority, &iWorkerPriority, &iFixPriority };
+        std::vector<uint32_t> seen{ initThreadId };
+
+        for (int pass = 0; pass < 12; ++pass) {
+            for (const auto& thread : Threads::Enumerate(baseModule, thisModule)) {
+                if (std::find(seen.begin(), seen.end(), thread.id) != seen.end())
+                    continue;
+                seen.push_back(thread.id);
+
+                // The input polling thread sets its own priority and shouldn't be pushed onto efficiency cores with the other fix threads.
+                if (thread.id == iInputPollingThreadId.load(std::memory_order_relaxed))
+                    continue;
+
+                Threads::Role role = Threads::Classify(thread);
+                if (role == Threads::Role::Unknown)
+                    continue;
+
+                const auto roleId = static_cast<size_t>(role);
+                const auto cores = static_cast<Threads::Cores>(*pCores[roleId]);
+                const uint64_t mask = (cores == Threads::Cores::Any) ? 0 : topology.Mask(cores);
+                const bool bApplied = Threads::Apply(thread.id, mask, *pPriorities[roleId]);
+                spdlog::info("Thread Scheduling: {} thread {} \"{}\" ({}): cores {:#x}, priority {:+}{}", Threads::RoleName(role), thread.id, thread.description, thread.module,
+                    mask, *pPriorities[roleId], bApplied ? "" : " (failed)");
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(5));
+        }
+        }).detach();
+}
+
+void TelemetryPublisher()
+{
+    if (!bTelemetry)
+        return;
+
+    Telemetry::Block* pBlock = Telemetry::Open();
+    if (!pBlock) {
+        spdlog::error("Telemetry: Failed to create shared memory block.");
+        return;
+    }
+    if (!Present_sh)
+        spdlog::warn("Telemetry: Present isn't hooked, the block will never be updated.");
+    pTelemetryBlock.store(pBlock, std::memory_order_release);
+    spdlog::info("Telemetry: Publishing to Local\\{} every frame.", Telemetry::SharedMemoryName);
+}
+
+// Subsystems that hook the exe, installed in this order. Each records its hooks under its own name in the trampoline arena.
+// The order is fixed: Resolution waits for the game to unpack itself, and everything after it scans code that's only there
+// once it has.
+struct HookedSubsystem
+{
+    const char* name;       // Arena and timeline name
+    void (*install)();
+    uint32_t traceHooks;    // Bit per Trace::Hook, for the hit profile
+};
+
+constexpr uint32_t TraceHookBit(Trace::Hook hook) { return 1u << static_cast<uint16_t>(hook); }
+
+constexpr HookedSubsystem HookedSubsystems[] = {
+    { "Graphics", Graphics, TraceHookBit(Trace::Hook::ResolutionScale) | TraceHookBit(Trace::Hook::AOResolution) },
+    { "Resolution", Resolution, TraceHookBit(Trace::Hook::ResolutionFix) },
+    { "IntroSkip", IntroSkip, TraceHookBit(Trace::Hook::IntroSkip) },
+    { "AspectRatioFOV", AspectRatioFOV, 0 },
+    { "HUD", HUD, 0 },
+    { "Misc", Misc, 0 },
+};
+Hooks::HitProfile ArenaHits;
+
+void InstallHookedSubsystems()
+{
+    for (const auto& subsystem : HookedSubsystems)
+        Timeline::Run(subsystem.name, subsystem.install);
+}
+
+// Called when the game window is destroyed. Hits are only counted with tracing or telemetry on, other runs leave the previous
+// profile alone.
+void SaveArenaHits()
+{
+    if (!Trace::bCountHits)
+        return;
+
+    for (const auto& subsystem : HookedSubsystems) {
+        uint64_t iHits = 0;
+        for (size_t i = 0; i < Trace::HookCount; ++i) {
+            if (subsystem.traceHooks & (1u << i))
+                iHits += Trace::hits[i].load(std::memory_order_relaxed);
+        }
+        ArenaHits.Set(subsystem.name, iHits);
+    }
+    ArenaHits.Save();
+}
+
+void HookArenaSummary()
+{
+    spdlog::info("----------");
+    size_t iTotalHooks = 0;
+    size_t iTotalBytes = 0;
+    std::vector<uintptr_t> allPages{};
+    for (const auto& arena : Hooks::arenas) {
+        size_t iArenaBytes = 0;
+        std::vector<uintptr_t> pages{};
+        for (const auto& placement : arena->Placements()) {
+            const uintptr_t firstPage = placement.address & ~uintptr_t(0xFFF);
+            const uintptr_t lastPage = (placement.address + (placement.bytes ? placement.bytes - 1 : 0)) & ~uintptr_t(0xFFF);
+            for (uintptr_t page = firstPage; page <= lastPage; page += 0x1000) {
+                if (std::find(pages.begin(), pages.end(), page) == pages.end())
+                    pages.push_back(page);
+                if (std::find(allPages.begin(), allPages.end(), page) == allPages.end())
+                    allPages.push_back(page);
+            }
+            iArenaBytes += placement.bytes;
+            spdlog::info("Hook Arena: {}: {:s}+{:x}: {} bytes at {:x} (page {:x})", arena->Name(), sExeName.c_str(), placement.target - (uintptr_t)baseModule, placement.bytes, placement.address, firstPage);
+        }
+        if (!arena->Placements().empty())
+            spdlog::info("Hook Arena: {}: {} hook(s), {} bytes on {} page(s), {} hit(s) last run.", arena->Name(), arena->Placements().size(), iArenaBytes, pages.size(), ArenaHits.Hits(arena->Name()));
+        iTotalHooks += arena->Placements().size();
+        iTotalBytes += iArenaBytes;
+    }
+    if (iTotalHooks)
+        spdlog::info("Hook Arena: {} hook(s), {} bytes on {} page(s) in total.", iTotalHooks, iTotalBytes, allPages.size());
+}
+
+void SignatureCacheSummary()
+{
+    static const char* sOutcomes[] = { "exact", "predicted", "window", "full scan", "not found" };
+
+    spdlog::info("----------");
+    long long iTotalMicroseconds = 0;
+    for (const auto& result : SigCache.Results()) {
+        iTotalMicroseconds += result.microseconds;
+        std::string sOutcome = sOutcomes[static_cast<int>(result.outcome)];
+        if (result.outcome == Memory::SignatureCache::Outcome::Window)
+            sOutcome += fmt::format(" +-0x{:x}", result.window);
+        if (result.bytesChanged)
+            sOutcome += ", bytes changed";
+        spdlog::info("Signature Cache: {:s}+{:x}: {} ({}us, {} attempt(s)) [{:.24s}...]", sExeName.c_str(), result.rva, sOutcome, result.microseconds, result.attempts, result.signature);
+    }
+    spdlog::info("Signature Cache: Total scan time: {}ms.", iTotalMicroseconds / 1000);
+
+    auto preResolve = SigCache.PreResolveResult();
+    if (!preResolve.error.empty())
+        spdlog::warn("Signature Cache: Pre-resolve from disk failed: {}", preResolve.error);
+    else if (!preResolve.finished)
+        spdlog::info("Signature Cache: Pre-resolve from disk still running.");
+    else if (preResolve.found == 0)
+        spdlog::warn("Signature Cache: Pre-resolve from disk found none of {} signatures, the executable is likely encrypted.", preResolve.total);
+    else
+        spdlog::info("Signature Cache: Pre-resolve from disk found {}/{} signatures in {}ms.", preResolve.found, preResolve.total, preResolve.milliseconds);
+    spdlog::info("----------");
+    SigCache.Save();
+}
+
+void StartupTimelineSummary()
+{
+    if (!bStartupTimeline)
+        return;
+
+    std::filesystem::path timelinePath = sThisModulePath / (sFixName + ".timeline.json");
+    if (Timeline::Write(timelinePath))
+        spdlog::info("Startup Timeline: Wrote {} span(s) to {}", std::min(Timeline::count.load(), Timeline::Capacity), timelinePath.string());
+    else
+        spdlog::error("Startup Timeline: Failed to write {}", timelinePath.string());
+}
+
 DWORD __stdcall Main(void*)
 {
-    Logging();
-    Configuration();
-    Graphics();
-    WindowManagement();
-    Resolution();
-    IntroSkip();
-    AspectRatioFOV();
-    HUD();
-    Misc();
+    // Start scanning the exe on disk while the game unpacks itself in memory.
+    wchar_t exePath[MAX_PATH] = {};
+    if (GetModuleFileNameW(baseModule, exePath, MAX_PATH))
+        SigCache.PreResolve(exePath, Signatures::All);
+
+    Timeline::Run("Main", []() {
+        Timeline::Run("Logging", Logging);
+        HookLog::Start();
+        Timeline::Run("SignatureCache Load", []() { SigCache.Load(sThisModulePath / (sFixName + ".sigcache")); });
+        ArenaHits.Load(sThisModulePath / (sFixName + ".hookhits"));
+        Timeline::Run("Configuration", Configuration);
+        ScheduleInitThread();
+        Timeline::Run("WindowManagement", WindowManagement);
+        InstallHookedSubsystems();
+        Timeline::Run("FrameHook", FrameHook);
+        Timeline::Run("InputPolling", InputPolling);
+        TelemetryPublisher();
+        ThreadScheduling();
+        HookArenaSummary();
+        SignatureCacheSummary();
+        });
+    StartupTimelineSummary();
     return true;
 }
 
@@ -1130,12 +1713,9 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD  ul_reason_for_call, LPVOID lpReser
             return FALSE;
 
         thisModule = hModule;
-        HANDLE mainHandle = CreateThread(NULL, 0, Main, 0, CREATE_SUSPENDED, 0);
-        if (mainHandle) {
-            SetThreadPriority(mainHandle, THREAD_PRIORITY_TIME_CRITICAL);
-            ResumeThread(mainHandle);
+        HANDLE mainHandle = CreateThread(NULL, 0, Main, 0, 0, 0);
+        if (mainHandle)
             CloseHandle(mainHandle);
-        }
         break;
     }
     case DLL_THREAD_ATTACH:
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "pattern.hpp"
+
+#ifdef _WIN32
+#include "stdafx.h"
+#endif
+
+// Function index built from the exception directory (.pdata).
+// Every non-leaf x64 function has a RUNTIME_FUNCTION entry, so this gives function bounds without disassembling anything.
+// Used to keep related hook sites inside the function they were found in, and to scan a single function instead of the whole image.
+// Everything but Build(module) works on plain image bytes, so tools/synth_image.cpp can run it on Linux.
+namespace Functions
+{
+    // Same layout as RUNTIME_FUNCTION.
+    struct RuntimeFunction
+    {
+        uint32_t BeginAddress;
+        uint32_t EndAddress;
+        uint32_t UnwindData;
+    };
+    static_assert(sizeof(RuntimeFunction) == 12);
+
+    // One contiguous block of code. Functions split by the compiler (hot/cold) have several, each pointing back at the primary entry.
+    struct Function
+    {
+        uintptr_t begin;
+        uintptr_t end;      // Exclusive
+        uintptr_t entry;    // Start of the primary block, the same as begin unless this is a chained block
+
+        bool Contains(uintptr_t address) const { return address >= begin && address < end; }
+        size_t Size() const { return end - begin; }
+    };
+
+    class Index
+    {
+    public:
+#ifdef _WIN32
+        bool Build(void* module)
+        {
+            auto imageBytes = reinterpret_cast<std::uint8_t*>(module);
+            auto dosHeader = (PIMAGE_DOS_HEADER)module;
+            auto ntHeaders = (PIMAGE_NT_HEADERS)(imageBytes + dosHeader->e_lfanew);
+            const auto& directory = ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXCEPTION];
+            return Build(imageBytes, ntHeaders->OptionalHeader.SizeOfImage, directory.VirtualAddress, directory.Size);
+        }
+#endif
+
+        // Builds the index from the exception table at tableRVA in an image laid out at RVAs.
+        bool Build(const std::uint8_t* imageBytes, uint32_t sizeOfImage, uint32_t tableRVA, uint32_t tableSize)
+        {
+            m_functions.clear();
+            if (!tableRVA || tableSize < sizeof(RuntimeFunction) || static_cast<size_t>(tableRVA) + tableSize > sizeOfImage)
+                return false;
+
+            const auto entries = reinterpret_cast<const RuntimeFunction*>(imageBytes + tableRVA);
+            const size_t count = tableSize / sizeof(RuntimeFunction);
+
+            m_functions.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                const RuntimeFunction& entry = entries[i];
+                if (entry.BeginAddress >= entry.EndAddress || entry.EndAddress > sizeOfImage)
+                    continue;
+                m_functions.push_back({ (uintptr_t)imageBytes + entry.BeginAddress, (uintptr_t)imageBytes + entry.EndAddress,
+                    (uintptr_t)imageBytes + PrimaryEntry(imageBytes, entry, sizeOfImage) });
+            }
+
+            // The linker emits the table sorted, but don't rely on it for the binary search.
+            std::sort(m_functions.begin(), m_functions.end(), [](const Function& a, const Function& b) { return a.begin < b.begin; });
+            return !m_functions.empty();
+        }
+
+        // The block containing address, or nullptr for leaf functions and anything outside the code. O(log n).
+        const Function* Find(uintptr_t address) const
+        {
+            auto it = std::upper_bound(m_functions.begin(), m_functions.end(), address, [](uintptr_t value, const Function& function) { return value < function.begin; });
+            if (it == m_functions.begin())
+                return nullptr;
+            --it;
+            return it->Contains(address) ? &*it : nullptr;
+        }
+
+        // True if both addresses are in the same function, counting chained blocks as part of their primary function.
+        bool SameFunction(uintptr_t a, uintptr_t b) const
+        {
+            const Function* first = Find(a);
+            const Function* second = Find(b);
+            return first && second && first->entry == second->entry;
+        }
+
+        size_t Size() const { return m_functions.size(); }
+        bool Empty() const { return m_functions.empty(); }
+
+    private:
+        std::vector<Function> m_functions{};
+
+        // Follows UNW_FLAG_CHAININFO back to the block that owns the function's prologue.
+        static uint32_t PrimaryEntry(const std::uint8_t* imageBytes, const RuntimeFunction& entry, uint32_t sizeOfImage)
+        {
+            constexpr std::uint8_t ChainInfo = 0x4;     // UNW_FLAG_CHAININFO
+            const RuntimeFunction* current = &entry;
+
+            // Chains are normally a single step. The limit only guards against a corrupt table.
+            for (int depth = 0; depth < 32; ++depth) {
+                if (current->UnwindData + 4 > sizeOfImage)
+                    break;
+                const std::uint8_t* unwindInfo = imageBytes + current->UnwindData;
+                const std::uint8_t flags = unwindInfo[0] >> 3;
+                if (!(flags & ChainInfo))
+                    break;
+
+                // The chained RUNTIME_FUNCTION follows the unwind codes, which are padded to an even count.
+                const std::uint8_t codeCount = unwindInfo[2];
+                const uint32_t chainOffset = current->UnwindData + 4 + ((codeCount + 1u) & ~1u) * 2;
+                if (chainOffset + sizeof(RuntimeFunction) > sizeOfImage)
+                    break;
+                current = reinterpret_cast<const RuntimeFunction*>(imageBytes + chainOffset);
+            }
+            return current->BeginAddress;
+        }
+    };
+
+    // Pattern scan limited to the block containing address.
+    inline std::uint8_t* PatternScanFunction(const Index& index, uintptr_t address, const char* signature)
+    {
+        const Function* function = index.Find(address);
+        if (!function)
+            return nullptr;
+        return Memory::PatternScanRange(reinterpret_cast<std::uint8_t*>(function->begin), function->Size(), signature);
+    }
+}
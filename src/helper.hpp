@@ -1,4 +1,6 @@
 #include "stdafx.h"
+#include "pattern.hpp"
+#include "timeline.hpp"
 
 namespace Memory
 {
@@ -19,53 +21,315 @@ namespace Memory
         VirtualProtect((LPVOID)address, numBytes, oldProtect, &oldProtect);
     }
 
-    // CSGOSimple's pattern scan
-    // https://github.com/OneshotGH/CSGOSimple-master/blob/master/CSGOSimple/helpers/utils.cpp
-    std::uint8_t* PatternScan(void* module, const char* signature)
+    // Plain store for memory that is already writable (heap, stack, game objects). No syscalls.
+    template<typename T>
+    void Store(uintptr_t writeAddress, T value)
     {
-        static auto pattern_to_byte = [](const char* pattern) {
-            auto bytes = std::vector<int>{};
-            auto start = const_cast<char*>(pattern);
-            auto end = const_cast<char*>(pattern) + strlen(pattern);
-
-            for (auto current = start; current < end; ++current) {
-                if (*current == '?') {
-                    ++current;
-                    if (*current == '?')
-                        ++current;
-                    bytes.push_back(-1);
-                }
-                else {
-                    bytes.push_back(strtoul(current, &current, 16));
-                }
+        *(reinterpret_cast<T*>(writeAddress)) = value;
+    }
+
+    // Batches code patches so each page only has its protection changed once.
+    // Writes are queued, then Commit() unprotects every touched page, applies them, restores protection and flushes the instruction cache.
+    class PatchTransaction
+    {
+    public:
+        template<typename T>
+        void Write(uintptr_t writeAddress, T value)
+        {
+            const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+            m_patches.push_back({ writeAddress, std::vector<std::uint8_t>(bytes, bytes + sizeof(T)) });
+        }
+
+        void PatchBytes(uintptr_t address, const char* pattern, unsigned int numBytes)
+        {
+            m_patches.push_back({ address, std::vector<std::uint8_t>(pattern, pattern + numBytes) });
+        }
+
+        // Returns the number of VirtualProtect calls made.
+        size_t Commit()
+        {
+            SYSTEM_INFO systemInfo{};
+            GetSystemInfo(&systemInfo);
+            const uintptr_t pageSize = systemInfo.dwPageSize;
+
+            // Collect every page touched, then merge adjacent pages into runs.
+            std::vector<uintptr_t> pages{};
+            for (const auto& patch : m_patches) {
+                for (uintptr_t page = patch.address & ~(pageSize - 1); page < patch.address + patch.bytes.size(); page += pageSize)
+                    pages.push_back(page);
+            }
+            std::sort(pages.begin(), pages.end());
+            pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+            struct Run { uintptr_t start; size_t size; DWORD oldProtect; };
+            std::vector<Run> runs{};
+            for (uintptr_t page : pages) {
+                if (!runs.empty() && runs.back().start + runs.back().size == page)
+                    runs.back().size += pageSize;
+                else
+                    runs.push_back({ page, pageSize, 0 });
+            }
+
+            size_t syscalls = 0;
+            for (auto& run : runs) {
+                VirtualProtect((LPVOID)run.start, run.size, PAGE_EXECUTE_READWRITE, &run.oldProtect);
+                ++syscalls;
+            }
+
+            for (const auto& patch : m_patches)
+                memcpy((LPVOID)patch.address, patch.bytes.data(), patch.bytes.size());
+
+            for (auto& run : runs) {
+                VirtualProtect((LPVOID)run.start, run.size, run.oldProtect, &run.oldProtect);
+                FlushInstructionCache(GetCurrentProcess(), (LPCVOID)run.start, run.size);
+                ++syscalls;
             }
-            return bytes;
-            };
 
+            m_patches.clear();
+            return syscalls;
+        }
+
+    private:
+        struct Patch
+        {
+            uintptr_t address;
+            std::vector<std::uint8_t> bytes;
+        };
+
+        std::vector<Patch> m_patches;
+    };
+
+    std::uint8_t* PatternScan(void* module, const char* signature)
+    {
         auto dosHeader = (PIMAGE_DOS_HEADER)module;
         auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
 
         auto sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
-        auto patternBytes = pattern_to_byte(signature);
-        auto scanBytes = reinterpret_cast<std::uint8_t*>(module);
-
-        auto s = patternBytes.size();
-        auto d = patternBytes.data();
-
-        for (auto i = 0ul; i < sizeOfImage - s; ++i) {
-            bool found = true;
-            for (auto j = 0ul; j < s; ++j) {
-                if (scanBytes[i + j] != d[j] && d[j] != -1) {
-                    found = false;
-                    break;
-                }
-            }
+        return PatternScanRange(reinterpret_cast<std::uint8_t*>(module), sizeOfImage, signature);
+    }
+
+    // Remembers where each signature was found last time, so a game update only costs a local search.
+    // Lookups (LookupCached in pattern.hpp) try the last known RVA, then the RVA predicted from the exe on disk, then widening windows
+    // around the last known RVA, then the whole image.
+    class SignatureCache
+    {
+    public:
+        using Outcome = CacheOutcome;
+
+        struct Result
+        {
+            std::string signature;
+            Outcome outcome = Outcome::NotFound;
+            uint32_t rva = 0;
+            size_t window = 0;
+            bool bytesChanged = false;
+            int attempts = 0;
+            long long microseconds = 0;
+        };
+
+        struct PreResolveStatus
+        {
+            bool finished = false;
+            size_t found = 0;
+            size_t total = 0;
+            long long milliseconds = 0;
+            std::string error;
+        };
+
+        void Load(const std::filesystem::path& path)
+        {
+            m_path = path;
+            std::ifstream file(path);
+            uint64_t key, fingerprint;
+            uint32_t rva;
+            while (file >> std::hex >> key >> rva >> fingerprint)
+                m_entries[key] = { rva, fingerprint };
+        }
+
+        void Save() const
+        {
+            std::scoped_lock lock(m_mutex);
+            std::ofstream file(m_path, std::ios::trunc);
+            for (const auto& [key, entry] : m_entries)
+                file << std::hex << key << " " << entry.rva << " " << entry.fingerprint << "\n";
+        }
+
+        std::uint8_t* Scan(void* module, const char* signature)
+        {
+            Timeline::Span span("Scan", "scan", signature);
+            auto start = std::chrono::steady_clock::now();
+            auto dosHeader = (PIMAGE_DOS_HEADER)module;
+            auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+            auto imageBytes = reinterpret_cast<std::uint8_t*>(module);
+            const size_t sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
+            const size_t patternSize = PatternToBytes(signature).size();
+            const uint64_t key = Hash(reinterpret_cast<const std::uint8_t*>(signature), strlen(signature));
+
+            Result result{ .signature = signature };
+
+            std::unique_lock lock(m_mutex);
+            auto cached = m_entries.find(key);
+            std::optional<Entry> entry = (cached != m_entries.end()) ? std::optional<Entry>(cached->second) : std::nullopt;
+            auto predictedIt = m_predicted.find(key);
+            std::optional<uint32_t> predicted = (predictedIt != m_predicted.end()) ? std::optional<uint32_t>(predictedIt->second) : std::nullopt;
+            lock.unlock();
+
+            const CacheLookup lookup = LookupCached(imageBytes, sizeOfImage, signature, entry, predicted);
+            std::uint8_t* found = lookup.found;
+            result.outcome = lookup.outcome;
+            result.window = lookup.window;
+
             if (found) {
-                return &scanBytes[i];
+                const uint64_t fingerprint = Hash(found, patternSize);
+                result.rva = static_cast<uint32_t>(found - imageBytes);
+                result.bytesChanged = entry && entry->fingerprint != fingerprint;
+                lock.lock();
+                m_entries[key] = { result.rva, fingerprint };
+                lock.unlock();
+            }
+
+            result.microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            lock.lock();
+            // Repeated scans of the same signature (e.g. while waiting for the game to unpack) share one result.
+            if (auto it = m_resultIndex.find(key); it != m_resultIndex.end()) {
+                result.attempts = m_results[it->second].attempts + 1;
+                result.microseconds += m_results[it->second].microseconds;
+                m_results[it->second] = result;
             }
+            else {
+                result.attempts = 1;
+                m_resultIndex[key] = m_results.size();
+                m_results.push_back(result);
+            }
+            return found;
         }
-        return nullptr;
-    }
+
+        // True while there is a last known or predicted RVA for the signature and the bytes there don't match yet,
+        // i.e. the game is most likely still unpacking. Much cheaper than a failed full scan.
+        bool Pending(void* module, const char* signature) const
+        {
+            auto dosHeader = (PIMAGE_DOS_HEADER)module;
+            auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+            auto imageBytes = reinterpret_cast<std::uint8_t*>(module);
+            const size_t sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
+            const size_t patternSize = PatternToBytes(signature).size();
+            const uint64_t key = Hash(reinterpret_cast<const std::uint8_t*>(signature), strlen(signature));
+
+            std::scoped_lock lock(m_mutex);
+            auto cached = m_entries.find(key);
+            auto predicted = m_predicted.find(key);
+            if (cached == m_entries.end() && predicted == m_predicted.end())
+                return false;
+            if (cached != m_entries.end() && VerifyAt(imageBytes, sizeOfImage, cached->second.rva, patternSize, signature))
+                return false;
+            if (predicted != m_predicted.end() && VerifyAt(imageBytes, sizeOfImage, predicted->second, patternSize, signature))
+                return false;
+            return true;
+        }
+
+        // Maps the executable on disk and scans its code sections for every signature on a background thread,
+        // converting file offsets to RVAs through the section table. Scan then only has to verify the predicted address.
+        // If the code on disk is encrypted or differs from what ends up in memory, signatures are either not found on disk
+        // or fail to verify, and Scan falls back to searching the image as usual.
+        void PreResolve(const std::filesystem::path& exePath, std::span<const char* const> signatures)
+        {
+            std::vector<const char*> pending(signatures.begin(), signatures.end());
+            {
+                std::scoped_lock lock(m_mutex);
+                m_preResolve = { .total = pending.size() };
+            }
+
+            std::thread([this, exePath, pending]() {
+                SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+                auto start = std::chrono::steady_clock::now();
+                std::string error = PreResolveFile(exePath, pending);
+
+                std::scoped_lock lock(m_mutex);
+                m_preResolve.finished = true;
+                m_preResolve.found = m_predicted.size();
+                m_preResolve.milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+                m_preResolve.error = error;
+                }).detach();
+        }
+
+        PreResolveStatus PreResolveResult() const
+        {
+            std::scoped_lock lock(m_mutex);
+            return m_preResolve;
+        }
+
+        // Outcome of every signature scanned so far, in order.
+        std::vector<Result> Results() const
+        {
+            std::scoped_lock lock(m_mutex);
+            return m_results;
+        }
+
+    private:
+        using Entry = CacheEntry;
+
+        // Returns an error message, or an empty string on success.
+        std::string PreResolveFile(const std::filesystem::path& exePath, const std::vector<const char*>& signatures)
+        {
+            HANDLE file = CreateFileW(exePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                return "Could not open executable.";
+
+            LARGE_INTEGER fileSize{};
+            GetFileSizeEx(file, &fileSize);
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            if (!mapping)
+                return "Could not map executable.";
+
+            auto view = static_cast<std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+            if (!view)
+                return "Could not map executable.";
+
+            const size_t size = static_cast<size_t>(fileSize.QuadPart);
+            std::string error{};
+            auto dosHeader = (PIMAGE_DOS_HEADER)view;
+            if (size < sizeof(IMAGE_DOS_HEADER) || dosHeader->e_magic != IMAGE_DOS_SIGNATURE || static_cast<size_t>(dosHeader->e_lfanew) + sizeof(IMAGE_NT_HEADERS) > size) {
+                error = "Not a PE file.";
+            }
+            else {
+                auto ntHeaders = (PIMAGE_NT_HEADERS)(view + dosHeader->e_lfanew);
+                auto section = IMAGE_FIRST_SECTION(ntHeaders);
+                const size_t sectionTableEnd = (std::uint8_t*)(section + ntHeaders->FileHeader.NumberOfSections) - view;
+                if (ntHeaders->Signature != IMAGE_NT_SIGNATURE || sectionTableEnd > size) {
+                    error = "Not a PE file.";
+                }
+                else {
+                    std::vector<CodeSection> sections{};
+                    for (WORD i = 0; i < ntHeaders->FileHeader.NumberOfSections; ++i, ++section) {
+                        if (!(section->Characteristics & IMAGE_SCN_CNT_CODE) || section->PointerToRawData >= size)
+                            continue;
+                        const size_t rawSize = std::min<size_t>({ section->SizeOfRawData, section->Misc.VirtualSize, size - section->PointerToRawData });
+                        sections.push_back({ view + section->PointerToRawData, rawSize, section->VirtualAddress });
+                    }
+
+                    for (const char* signature : signatures) {
+                        if (auto rva = PredictRVA(sections, signature)) {
+                            std::scoped_lock lock(m_mutex);
+                            m_predicted[Hash(reinterpret_cast<const std::uint8_t*>(signature), strlen(signature))] = *rva;
+                        }
+                    }
+                }
+            }
+
+            UnmapViewOfFile(view);
+            return error;
+        }
+
+        std::filesystem::path m_path;
+        std::map<uint64_t, Entry> m_entries;
+        std::vector<Result> m_results;
+        std::map<uint64_t, size_t> m_resultIndex;
+        std::map<uint64_t, uint32_t> m_predicted;   // RVAs found in the exe on disk
+        PreResolveStatus m_preResolve;
+        mutable std::mutex m_mutex;
+    };
 
     static HMODULE GetThisDllHandle()
     {
@@ -82,6 +346,20 @@ namespace Memory
         return ntHeaders->FileHeader.TimeDateStamp;
     }
 
+    // Returns the start and size of a section in a loaded module, or {nullptr, 0} if it isn't found.
+    std::pair<std::uint8_t*, size_t> GetSection(void* module, const char* sectionName)
+    {
+        auto dosHeader = (PIMAGE_DOS_HEADER)module;
+        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+        auto section = IMAGE_FIRST_SECTION(ntHeaders);
+
+        for (WORD i = 0; i < ntHeaders->FileHeader.NumberOfSections; ++i, ++section) {
+            if (strncmp(reinterpret_cast<const char*>(section->Name), sectionName, IMAGE_SIZEOF_SHORT_NAME) == 0)
+                return { (std::uint8_t*)module + section->VirtualAddress, section->Misc.VirtualSize };
+        }
+        return { nullptr, 0 };
+    }
+
     uintptr_t GetAbsolute(uintptr_t address) noexcept
     {
         return (address + 4 + *reinterpret_cast<std::int32_t*>(address));
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <array>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/bundled/args.h>
+
+// Logging for hook callbacks, which run on the game's threads.
+// Messages are deduplicated and rate-limited per call site, then handed to a background thread through a fixed-size queue.
+// Nothing on the calling side allocates, formats or takes the spdlog sink mutex.
+
+// Levels below this are compiled out. Uses spdlog's level numbering (0 = trace, 1 = debug, 2 = info).
+#ifndef HOOKLOG_LEVEL
+#ifdef NDEBUG
+#define HOOKLOG_LEVEL 2
+#else
+#define HOOKLOG_LEVEL 0
+#endif
+#endif
+
+// Usage: HOOKLOG_INFO("Format {}", value). The first argument must be a string literal.
+// Values are numbers, bools or strings that outlive the log, such as literals or names from a static table. Only the pointer is queued.
+#define HOOKLOG(hookLogLevel_, ...) \
+    do { \
+        if constexpr ((hookLogLevel_) >= HOOKLOG_LEVEL) { \
+            static HookLog::Site hookLogSite_{ HookLog::Format(__VA_ARGS__), static_cast<spdlog::level::level_enum>(hookLogLevel_) }; \
+            HookLog::Post(hookLogSite_, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define HOOKLOG_DEBUG(...) HOOKLOG(1, __VA_ARGS__)
+#define HOOKLOG_INFO(...) HOOKLOG(2, __VA_ARGS__)
+#define HOOKLOG_WARN(...) HOOKLOG(3, __VA_ARGS__)
+
+namespace HookLog
+{
+    // Minimum time between two messages from the same call site.
+    inline constexpr auto RateLimit = std::chrono::milliseconds(1000);
+    inline constexpr size_t MaxArgs = 8;
+    inline constexpr size_t QueueSize = 256;
+
+    struct Site
+    {
+        const char* format;
+        spdlog::level::level_enum level;
+        std::atomic<uint64_t> lastHash{ 0 };
+        std::atomic<int64_t> lastPosted{ INT64_MIN / 2 };
+        std::atomic<uint32_t> suppressed{ 0 };
+    };
+
+    struct Arg
+    {
+        enum class Type : uint8_t { Int, UInt, Float, Double, Bool, String } type;
+        union
+        {
+            int64_t i;
+            uint64_t u;
+            float f;
+            double d;
+            bool b;
+            const char* s;
+        };
+    };
+
+    struct Record
+    {
+        std::atomic<size_t> sequence;
+        const Site* site;
+        uint32_t suppressed;
+        uint8_t count;
+        Arg args[MaxArgs];
+    };
+
+    // Bounded multi-producer, single-consumer queue (Vyukov). Slots are preallocated.
+    inline std::array<Record, QueueSize> queue{};
+    inline std::atomic<size_t> enqueuePos{ 0 };
+    inline size_t dequeuePos = 0;
+    inline std::atomic<uint32_t> dropped{ 0 };
+    inline std::atomic<bool> bRunning{ false };
+
+    template<typename T>
+    Arg MakeArg(T value)
+    {
+        Arg arg{};
+        if constexpr (std::is_same_v<T, bool>) { arg.type = Arg::Type::Bool; arg.b = value; }
+        else if constexpr (std::is_same_v<T, const char*>) { arg.type = Arg::Type::String; arg.s = value; }
+        else if constexpr (std::is_same_v<T, float>) { arg.type = Arg::Type::Float; arg.f = value; }
+        else if constexpr (std::is_floating_point_v<T>) { arg.type = Arg::Type::Double; arg.d = static_cast<double>(value); }
+        else if constexpr (std::is_signed_v<T>) { arg.type = Arg::Type::Int; arg.i = static_cast<int64_t>(value); }
+        else { static_assert(std::is_unsigned_v<T>, "HookLog only takes arithmetic and static string arguments."); arg.type = Arg::Type::UInt; arg.u = static_cast<uint64_t>(value); }
+        return arg;
+    }
+
+    template<typename... Args>
+    constexpr const char* Format(const char* format, Args...) { return format; }
+
+    template<typename... Args>
+    void Post(Site& site, const char*, Args... values)
+    {
+        if (!bRunning.load(std::memory_order_acquire))
+            return;
+
+        static_assert(sizeof...(Args) <= MaxArgs, "Too many HookLog arguments.");
+        const Arg args[sizeof...(Args) + 1] = { MakeArg(values)..., Arg{} };
+
+        // FNV-1a over the raw argument bits
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (size_t i = 0; i < sizeof...(Args); ++i) {
+            const auto* bytes = reinterpret_cast<const uint8_t*>(&args[i].u);
+            for (size_t j = 0; j < sizeof(uint64_t); ++j)
+                hash = (hash ^ bytes[j]) * 0x100000001B3ull;
+        }
+
+        // Same arguments as the last message this site actually posted. Messages dropped below don't count, so a value
+        // that arrived inside the rate limit is still posted the next time the site sees it.
+        if (site.lastHash.load(std::memory_order_relaxed) == hash) {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t last = site.lastPosted.load(std::memory_order_relaxed);
+        if (now - last < RateLimit.count() || !site.lastPosted.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Record* record = nullptr;
+        for (;;) {
+            record = &queue[pos % QueueSize];
+            const size_t sequence = record->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0) {
+                // Queue full
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        site.lastHash.store(hash, std::memory_order_relaxed);
+        record->site = &site;
+        record->suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+        record->count = static_cast<uint8_t>(sizeof...(Args));
+        for (size_t i = 0; i < sizeof...(Args); ++i)
+            record->args[i] = args[i];
+        record->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    inline void Drain()
+    {
+        for (;;) {
+            Record& record = queue[dequeuePos % QueueSize];
+            if (record.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+                break;
+
+            fmt::dynamic_format_arg_store<fmt::format_context> store;
+            for (uint8_t i = 0; i < record.count; ++i) {
+                const Arg& arg = record.args[i];
+                switch (arg.type) {
+                case Arg::Type::Int: store.push_back(arg.i); break;
+                case Arg::Type::UInt: store.push_back(arg.u); break;
+                case Arg::Type::Float: store.push_back(arg.f); break;
+                case Arg::Type::Double: store.push_back(arg.d); break;
+                case Arg::Type::Bool: store.push_back(arg.b); break;
+                case Arg::Type::String: store.push_back(arg.s); break;
+                }
+            }
+
+            try {
+                std::string message = fmt::vformat(record.site->format, store);
+                if (record.suppressed)
+                    message += fmt::format(" ({} similar suppressed)", record.suppressed);
+                spdlog::log(record.site->level, message);
+            }
+            catch (const fmt::format_error& ex) {
+                spdlog::error("HookLog: Bad format string \"{}\": {}", record.site->format, ex.what());
+            }
+
+            record.sequence.store(dequeuePos + QueueSize, std::memory_order_release);
+            ++dequeuePos;
+        }
+
+        if (uint32_t count = dropped.exchange(0, std::memory_order_relaxed))
+            spdlog::warn("HookLog: Dropped {} message(s), queue was full.", count);
+    }
+
+    // Starts the background thread that writes queued messages to the default logger.
+    inline void Start()
+    {
+        if (bRunning.load())
+            return;
+
+        for (size_t i = 0; i < QueueSize; ++i)
+            queue[i].sequence.store(i, std::memory_order_relaxed);
+        bRunning.store(true, std::memory_order_release);
+
+        std::thread([]() {
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+            while (bRunning.load(std::memory_order_relaxed)) {
+                Drain();
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+            }).detach();
+    }
+}
@@ -0,0 +1,307 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <safetyhook.hpp>
+#include <Zydis.h>
+
+#include <cstring>
+#include <memory>
+
+#include "stub.hpp"
+#include "timeline.hpp"
+
+namespace Hooks
+{
+    // Trampoline arena.
+    // SafetyHook's global allocator hands out stubs and trampolines in whatever order hooks are created, next to hooks on
+    // system DLLs. Exe hooks get one allocator of their own instead, in a block next to the game's code. Allocation is first
+    // fit, so each subsystem's hooks are packed one after another and the subsystems follow each other in install order.
+    inline const std::shared_ptr<safetyhook::Allocator>& ArenaAllocator()
+    {
+        static const std::shared_ptr<safetyhook::Allocator> allocator = []() {
+            auto created = safetyhook::Allocator::create();
+            // Take a block near the exe and give it straight back. The block stays mapped, so stubs (which SafetyHook places
+            // anywhere) and trampolines (which must be within rel32 of the target) both come from it.
+            auto reserve = created->allocate_near({ reinterpret_cast<uint8_t*>(GetModuleHandleW(nullptr)) }, 1);
+            return created;
+            }();
+        return allocator;
+    }
+
+    // One subsystem's share of the arena.
+    class Arena
+    {
+    public:
+        struct Placement
+        {
+            uintptr_t target;
+            uintptr_t address;  // Start of the stub/trampoline bytes this hook added
+            size_t bytes;
+        };
+
+        explicit Arena(const char* name) : m_name(name) {}
+
+        // Creates a hook with the arena allocator and records how many bytes it took and where.
+        template<typename Fn>
+        auto Place(void* target, Fn&& create)
+        {
+            const auto& allocator = ArenaAllocator();
+            const uintptr_t before = NextFree(allocator);
+            auto hook = create(allocator);
+            const uintptr_t after = NextFree(allocator);
+            // If the hook didn't fit in the first block the difference means nothing, so record it without a size.
+            m_placements.push_back({ reinterpret_cast<uintptr_t>(target), before, (before && after > before) ? after - before : 0 });
+            return hook;
+        }
+
+        const char* Name() const { return m_name; }
+        const std::vector<Placement>& Placements() const { return m_placements; }
+
+    private:
+        const char* m_name;
+        std::vector<Placement> m_placements{};
+
+        // Allocation is first fit, so a one byte probe lands on the lowest free address.
+        static uintptr_t NextFree(const std::shared_ptr<safetyhook::Allocator>& allocator)
+        {
+            auto probe = allocator->allocate(1);
+            return probe ? probe->address() : 0;
+        }
+    };
+
+    // Hook hits per arena from the previous run. Subsystems are installed busiest first, so the hooks that fire most
+    // share the first pages of the arena.
+    class HitProfile
+    {
+    public:
+        void Load(const std::filesystem::path& path)
+        {
+            m_path = path;
+            std::ifstream file(path);
+            std::string name;
+            uint64_t hits;
+            while (file >> name >> hits)
+                m_hits[name] = hits;
+        }
+
+        void Save() const
+        {
+            std::ofstream file(m_path, std::ios::trunc);
+            for (const auto& [name, hits] : m_hits)
+                file << name << " " << hits << "\n";
+        }
+
+        uint64_t Hits(const std::string& name) const
+        {
+            auto it = m_hits.find(name);
+            return (it != m_hits.end()) ? it->second : 0;
+        }
+
+        void Set(const std::string& name, uint64_t hits) { m_hits[name] = hits; }
+
+    private:
+        std::filesystem::path m_path;
+        std::map<std::string, uint64_t> m_hits{};
+    };
+
+    inline std::vector<std::unique_ptr<Arena>> arenas{};
+    inline Arena* currentArena = nullptr;
+
+    // Hooks created while a scope is alive are recorded against the named arena. Scopes don't nest.
+    // Only for hooks in the exe. Hooks on system DLLs need trampolines near those DLLs, so they stay on the global allocator.
+    class ArenaScope
+    {
+    public:
+        explicit ArenaScope(const char* name)
+        {
+            auto it = std::find_if(arenas.begin(), arenas.end(), [&](const auto& arena) { return strcmp(arena->Name(), name) == 0; });
+            currentArena = (it != arenas.end()) ? it->get() : arenas.emplace_back(std::make_unique<Arena>(name)).get();
+        }
+
+        ~ArenaScope() { currentArena = nullptr; }
+
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+    };
+
+    // Thin wrappers over SafetyHook so every hook install shows up on the startup timeline and lands in the current arena.
+    inline SafetyHookMid CreateMid(void* target, safetyhook::MidHookFn destination)
+    {
+        Timeline::Span span("CreateMid", "hook");
+        if (!currentArena)
+            return safetyhook::create_mid(target, destination);
+
+        return currentArena->Place(target, [&](const std::shared_ptr<safetyhook::Allocator>& allocator) -> SafetyHookMid {
+            if (auto hook = safetyhook::MidHook::create(allocator, target, destination))
+                return std::move(*hook);
+            return {};
+            });
+    }
+
+    inline SafetyHookInline CreateInline(void* target, void* destination)
+    {
+        Timeline::Span span("CreateInline", "hook");
+        if (!currentArena)
+            return safetyhook::create_inline(target, destination);
+
+        return currentArena->Place(target, [&](const std::shared_ptr<safetyhook::Allocator>& allocator) -> SafetyHookInline {
+            if (auto hook = safetyhook::InlineHook::create(allocator, target, destination))
+                return std::move(*hook);
+            return {};
+            });
+    }
+
+    // Replacement for mid hooks that only load one register from a global.
+    // Instead of SafetyHook's full context save/restore, the stub loads the register and jumps straight to the trampoline.
+    class RegisterLoadHook
+    {
+    public:
+        RegisterLoadHook() = default;
+        RegisterLoadHook(RegisterLoadHook&&) noexcept = default;
+        RegisterLoadHook& operator=(RegisterLoadHook&&) noexcept = default;
+
+        // Loads *source into reg before the instruction at target runs.
+        // source must point to a uint64_t for general purpose registers or a float for XMM registers.
+        // If condition is set, the load is skipped while *condition is false.
+        static RegisterLoadHook Create(void* target, Register reg, const void* source, const bool* condition = nullptr)
+        {
+            Timeline::Span span("RegisterLoadHook", "hook");
+            RegisterLoadHook hook{};
+            if (!target || !source || reg == Register::RSP)
+                return hook;
+
+            const RegisterLoadStub emitted = EmitRegisterLoad(reg, source, condition);
+
+            auto install = [&](const std::shared_ptr<safetyhook::Allocator>& allocator) {
+                auto stub = allocator->allocate(emitted.code.size());
+                if (!stub)
+                    return false;
+
+                hook.m_stub = std::move(*stub);
+                std::copy(emitted.code.begin(), emitted.code.end(), hook.m_stub.data());
+
+                auto inlineHook = safetyhook::InlineHook::create(allocator, target, hook.m_stub.data());
+                if (!inlineHook) {
+                    hook.m_stub.free();
+                    return false;
+                }
+
+                hook.m_hook = std::move(*inlineHook);
+                safetyhook::store(hook.m_stub.data() + emitted.trampolineSlot, hook.m_hook.trampoline().data());
+                return true;
+                };
+
+            if (currentArena)
+                currentArena->Place(target, install);
+            else
+                install(safetyhook::Allocator::global());
+            return hook;
+        }
+
+        explicit operator bool() const { return static_cast<bool>(m_hook) && static_cast<bool>(m_stub); }
+
+    private:
+        // Declared before m_hook so the target is restored before the stub is freed.
+        safetyhook::Allocation m_stub{};
+        safetyhook::InlineHook m_hook{};
+    };
+
+    // Redirects a RIP-relative float load to a fix-owned slot, so a constant can be swapped without hooking.
+    // Used in place of mid hooks that only replace a register the game has just loaded from a constant.
+    class ConstantPatch
+    {
+    public:
+        ConstantPatch() = default;
+        ConstantPatch(ConstantPatch&&) noexcept = default;
+        ConstantPatch& operator=(ConstantPatch&&) noexcept = default;
+
+        // site is where the mid hook would have been placed. The instruction ending at site must be a
+        // movss/vmovss of the expected value from [rip+disp] into reg, which is checked with Zydis before patching.
+        static ConstantPatch Create(uint8_t* site, Register reg, float expected)
+        {
+            ConstantPatch patch{};
+            if (!site || static_cast<uint8_t>(reg) < static_cast<uint8_t>(Register::XMM0))
+                return patch;
+
+            const auto targetReg = static_cast<ZydisRegister>(ZYDIS_REGISTER_XMM0 + (static_cast<uint8_t>(reg) - static_cast<uint8_t>(Register::XMM0)));
+
+            ZydisDecoder decoder{};
+            if (!ZYAN_SUCCESS(ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64)))
+                return patch;
+
+            // Walk back to find an instruction that ends exactly at the hook site.
+            for (uint8_t length = ZYDIS_MAX_INSTRUCTION_LENGTH; length > 0; --length) {
+                uint8_t* ip = site - length;
+
+                ZydisDecodedInstruction ix{};
+                ZydisDecodedOperand operands[ZYDIS_MAX_OPERAND_COUNT]{};
+                if (!ZYAN_SUCCESS(ZydisDecoderDecodeFull(&decoder, ip, length, &ix, operands)) || ix.length != length)
+                    continue;
+
+                if (ix.mnemonic != ZYDIS_MNEMONIC_MOVSS && ix.mnemonic != ZYDIS_MNEMONIC_VMOVSS)
+                    continue;
+                if (ix.operand_count_visible != 2 || ix.raw.disp.size != 32)
+                    continue;
+                if (operands[0].type != ZYDIS_OPERAND_TYPE_REGISTER || operands[0].reg.value != targetReg)
+                    continue;
+                if (operands[1].type != ZYDIS_OPERAND_TYPE_MEMORY || operands[1].mem.base != ZYDIS_REGISTER_RIP || operands[1].size != 32)
+                    continue;
+
+                auto constantAddr = reinterpret_cast<float*>(site + operands[1].mem.disp.value);
+                if (*constantAddr != expected)
+                    continue;
+
+                // The slot has to be reachable with a rel32 displacement from the instruction.
+                auto slot = safetyhook::Allocator::global()->allocate_near({ site }, sizeof(float));
+                if (!slot)
+                    return patch;
+
+                patch.m_slot = std::move(*slot);
+                patch.m_original = *constantAddr;
+                patch.m_dispAddress = ip + ix.raw.disp.offset;
+                patch.m_originalDisp = static_cast<int32_t>(ix.raw.disp.value);
+                safetyhook::store(patch.m_slot.data(), patch.m_original);
+
+                const auto newDisp = static_cast<int32_t>(patch.m_slot.address() - reinterpret_cast<uintptr_t>(site));
+                if (auto unprotect = safetyhook::unprotect(patch.m_dispAddress, sizeof(int32_t))) {
+                    safetyhook::store(patch.m_dispAddress, newDisp);
+                    return patch;
+                }
+
+                patch.m_dispAddress = nullptr;
+                patch.m_slot.free();
+                return patch;
+            }
+
+            return patch;
+        }
+
+        ~ConstantPatch()
+        {
+            // Point the instruction back at the game's constant before the slot is freed.
+            if (m_dispAddress && m_slot) {
+                if (auto unprotect = safetyhook::unprotect(m_dispAddress, sizeof(int32_t)))
+                    safetyhook::store(m_dispAddress, m_originalDisp);
+            }
+        }
+
+        // Value the game would have loaded.
+        float Original() const { return m_original; }
+
+        // Slot is ordinary writable memory, so this is a plain store.
+        void Set(float value)
+        {
+            if (m_slot)
+                *reinterpret_cast<volatile float*>(m_slot.data()) = value;
+        }
+
+        explicit operator bool() const { return m_dispAddress != nullptr && static_cast<bool>(m_slot); }
+
+    private:
+        safetyhook::Allocation m_slot{};
+        uint8_t* m_dispAddress{};
+        int32_t m_originalDisp{};
+        float m_original{};
+    };
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+// Controller polling for the input polling option.
+// A dedicated thread samples the pads at a fixed rate, filters them and publishes the latest state.
+// The game's XInputGetState calls then read the published state instead of querying the device.
+// The header itself is plain C++ and works against any device with a GetState(index, Pad&) member.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace Input
+{
+    inline constexpr uint32_t MaxPads = 4;
+    inline constexpr uint32_t Success = 0;                  // ERROR_SUCCESS
+    inline constexpr uint32_t NotConnected = 1167;          // ERROR_DEVICE_NOT_CONNECTED
+
+    // Same fields as XINPUT_STATE.
+    struct Pad
+    {
+        uint32_t packet;
+        uint16_t buttons;
+        uint8_t leftTrigger;
+        uint8_t rightTrigger;
+        int16_t leftX;
+        int16_t leftY;
+        int16_t rightX;
+        int16_t rightY;
+    };
+    static_assert(sizeof(Pad) == 16);
+
+    struct FilterSettings
+    {
+        int deadzone = 0;           // Radial, in stick units (0-32767). 0 leaves sticks untouched.
+        float smoothing = 0.00f;    // 0 = none. Weight given to the previous sample, 0-0.9.
+    };
+
+    // Radial deadzone with the remaining range rescaled to full deflection, then optional exponential smoothing.
+    class Filter
+    {
+    public:
+        Pad Process(const Pad& raw, const FilterSettings& settings)
+        {
+            Pad pad = raw;
+            Stick(pad.leftX, pad.leftY, m_left, settings);
+            Stick(pad.rightX, pad.rightY, m_right, settings);
+            return pad;
+        }
+
+        void Reset()
+        {
+            m_left = {};
+            m_right = {};
+        }
+
+    private:
+        struct State
+        {
+            float x = 0.00f;
+            float y = 0.00f;
+        };
+
+        State m_left{};
+        State m_right{};
+
+        static void Stick(int16_t& outX, int16_t& outY, State& state, const FilterSettings& settings)
+        {
+            float x = outX;
+            float y = outY;
+
+            if (settings.deadzone > 0) {
+                const float magnitude = std::sqrt(x * x + y * y);
+                const float deadzone = static_cast<float>(std::min(settings.deadzone, 32766));
+                if (magnitude <= deadzone) {
+                    x = 0.00f;
+                    y = 0.00f;
+                }
+                else {
+                    const float scaled = std::min(32767.00f, (magnitude - deadzone) / (32767.00f - deadzone) * 32767.00f);
+                    x = x / magnitude * scaled;
+                    y = y / magnitude * scaled;
+                }
+            }
+
+            if (settings.smoothing > 0.00f) {
+                const float weight = std::clamp(settings.smoothing, 0.00f, 0.90f);
+                x = state.x * weight + x * (1.00f - weight);
+                y = state.y * weight + y * (1.00f - weight);
+            }
+            state = { x, y };
+
+            outX = static_cast<int16_t>(std::clamp(std::lround(x), -32768l, 32767l));
+            outY = static_cast<int16_t>(std::clamp(std::lround(y), -32768l, 32767l));
+        }
+    };
+
+    // Single-writer seqlock. Readers never block the polling thread and retry if they raced a write.
+    class Mailbox
+    {
+    public:
+        void Publish(const Pad& pad, uint32_t result)
+        {
+            uint64_t words[2];
+            memcpy(words, &pad, sizeof(words));
+
+            const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+            m_sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_words[0].store(words[0], std::memory_order_relaxed);
+            m_words[1].store(words[1], std::memory_order_relaxed);
+            m_result.store(result, std::memory_order_relaxed);
+            m_sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        // Returns the result code of the last poll, or NotConnected if nothing has been published yet.
+        uint32_t Read(Pad& pad) const
+        {
+            for (;;) {
+                const uint32_t before = m_sequence.load(std::memory_order_acquire);
+                if (before == 0)
+                    return NotConnected;
+                if (before & 1)
+                    continue;
+
+                uint64_t words[2] = { m_words[0].load(std::memory_order_relaxed), m_words[1].load(std::memory_order_relaxed) };
+                const uint32_t result = m_result.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == before) {
+                    memcpy(&pad, words, sizeof(words));
+                    return result;
+                }
+            }
+        }
+
+    private:
+        std::atomic<uint32_t> m_sequence{ 0 };
+        std::atomic<uint64_t> m_words[2]{};
+        std::atomic<uint32_t> m_result{ NotConnected };
+    };
+
+    // Polls every pad once per Step. Disconnected pads are only retried every reconnectInterval steps,
+    // since XInputGetState on an empty slot is slow.
+    template<typename Device>
+    class Poller
+    {
+    public:
+        explicit Poller(Device& device) : m_device(device) {}
+
+        void Step(const FilterSettings& settings, uint32_t reconnectInterval)
+        {
+            for (uint32_t i = 0; i < MaxPads; ++i) {
+                if (!m_connected[i] && (m_steps % reconnectInterval) != 0)
+                    continue;
+
+                Pad raw{};
+                const uint32_t result = m_device.GetState(i, raw);
+                m_connected[i] = (result == Success);
+                if (m_connected[i]) {
+                    // Filtering can change the sticks between device packets, so packet numbers are our own.
+                    Pad pad = m_filters[i].Process(raw, settings);
+                    pad.packet = m_last[i].packet;
+                    if (memcmp(&pad, &m_last[i], sizeof(Pad)) != 0)
+                        ++pad.packet;
+                    m_last[i] = pad;
+                    mailboxes[i].Publish(pad, result);
+                }
+                else {
+                    m_filters[i].Reset();
+                    mailboxes[i].Publish(Pad{}, result);
+                }
+            }
+            ++m_steps;
+        }
+
+        Mailbox mailboxes[MaxPads];
+
+    private:
+        Device& m_device;
+        Filter m_filters[MaxPads];
+        bool m_connected[MaxPads]{};
+        Pad m_last[MaxPads]{};
+        uint64_t m_steps = 0;
+    };
+}
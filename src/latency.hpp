@@ -0,0 +1,261 @@
+#pragma once
+
+// Render queue limiter.
+// With vsync off the CPU can queue several frames ahead of the GPU, so input is read that many frames before it is shown.
+// After each present the limiter waits until at most Depth presented frames are still unfinished on the GPU, which holds
+// back the start of the next frame's simulation. The GPU signal and the clock are template parameters, so the same logic
+// runs against a D3D11 fence in game and against a fake GPU and clock in tools/latency_check.cpp.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <d3d11_4.h>
+#endif
+
+namespace Latency
+{
+    inline constexpr size_t MaxDepth = 3;
+
+    struct Frame
+    {
+        double simToPresent;    // Seconds from the end of the previous present to this one, i.e. how long this frame's CPU work took
+        double presentToDone;   // Seconds from this present until the GPU was seen to have finished it
+    };
+
+    // The limiter doesn't own the signal, so whoever created it releases it.
+    // Signal needs: a Token type, Token Issue() (mark the end of the frame just presented), bool Done(Token) (non-blocking)
+    // and void Wait(Token). Up to MaxDepth + 1 tokens are outstanding at once.
+    // Clock needs: double Now() in seconds.
+    template<typename Signal, typename Clock>
+    class Limiter
+    {
+    public:
+        Limiter(Signal& signal, Clock clock, size_t depth) : m_signal(signal), m_clock(clock) { SetDepth(depth); }
+
+        void SetDepth(size_t depth) { m_depth = std::clamp<size_t>(depth, 1, MaxDepth); }
+        size_t Depth() const { return m_depth; }
+        size_t Queued() const { return m_count; }
+
+        // Call just before the game's present.
+        void BeforePresent() { m_presentTime = m_clock.Now(); }
+
+        // Call just after the game's present. Calls retired(const Frame&) for every frame the GPU has finished, oldest first,
+        // and returns how long it waited in seconds.
+        template<typename Fn>
+        double AfterPresent(Fn&& retired)
+        {
+            const double simToPresent = (m_simStart >= 0.0) ? m_presentTime - m_simStart : 0.0;
+            m_queue[(m_head + m_count) % m_queue.size()] = { m_signal.Issue(), m_presentTime, simToPresent };
+            ++m_count;
+
+            while (m_count && m_signal.Done(m_queue[m_head].token))
+                Retire(retired);
+
+            const double waitStart = m_clock.Now();
+            while (m_count > m_depth) {
+                m_signal.Wait(m_queue[m_head].token);
+                Retire(retired);
+            }
+
+            m_simStart = m_clock.Now();
+            return m_simStart - waitStart;
+        }
+
+    private:
+        struct Pending
+        {
+            typename Signal::Token token;
+            double presentTime;
+            double simToPresent;
+        };
+
+        Signal& m_signal;
+        Clock m_clock;
+        size_t m_depth = 1;
+        std::array<Pending, MaxDepth + 1> m_queue{};
+        size_t m_head = 0;
+        size_t m_count = 0;
+        double m_presentTime = 0.0;
+        double m_simStart = -1.0;
+
+        template<typename Fn>
+        void Retire(Fn& retired)
+        {
+            const Pending& pending = m_queue[m_head];
+            retired(Frame{ pending.simToPresent, m_clock.Now() - pending.presentTime });
+            m_head = (m_head + 1) % m_queue.size();
+            --m_count;
+        }
+    };
+
+    // Polling wait for when there's nothing to block on: spins briefly for a signal that is about to arrive, then gives the
+    // core away, first to other ready threads and then to the OS for a millisecond at a time.
+    class Backoff
+    {
+    public:
+        void Pause()
+        {
+            if (m_count >= SpinCount + YieldCount)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            else if (m_count >= SpinCount)
+                std::this_thread::yield();
+            ++m_count;
+        }
+
+    private:
+        static constexpr uint32_t SpinCount = 64;
+        static constexpr uint32_t YieldCount = 16;
+        uint32_t m_count = 0;
+    };
+
+    // Running totals for the periodic log line.
+    struct Summary
+    {
+        size_t frames = 0;
+        double simToPresent = 0.0;
+        double simToPresentMax = 0.0;
+        double presentToDone = 0.0;
+        double waited = 0.0;
+
+        void Add(const Frame& frame)
+        {
+            ++frames;
+            simToPresent += frame.simToPresent;
+            simToPresentMax = std::max(simToPresentMax, frame.simToPresent);
+            presentToDone += frame.presentToDone;
+        }
+    };
+
+#ifdef _WIN32
+    // Marks the end of each presented frame on the GPU. Must be used on the thread that presents.
+    // Uses a D3D11.4 fence, so Wait blocks on an event. Without one (Windows 10 before 1703) it falls back to event queries
+    // polled with Backoff.
+    class GpuSignal
+    {
+    public:
+        using Token = uint64_t;
+
+        bool Create(ID3D11Device* device)
+        {
+            device->GetImmediateContext(&m_context);
+            if (!m_context)
+                return false;
+
+            ID3D11Device5* device5 = nullptr;
+            if (SUCCEEDED(device->QueryInterface(__uuidof(ID3D11Device5), reinterpret_cast<void**>(&device5))) && device5) {
+                if (SUCCEEDED(m_context->QueryInterface(__uuidof(ID3D11DeviceContext4), reinterpret_cast<void**>(&m_context4))) && m_context4
+                    && SUCCEEDED(device5->CreateFence(0, D3D11_FENCE_FLAG_NONE, __uuidof(ID3D11Fence), reinterpret_cast<void**>(&m_fence))))
+                    m_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+                device5->Release();
+                if (m_event)
+                    return true;
+                ReleaseFence();
+            }
+
+            D3D11_QUERY_DESC desc{ D3D11_QUERY_EVENT, 0 };
+            for (auto& query : m_queries) {
+                if (FAILED(device->CreateQuery(&desc, &query)))
+                    return false;
+            }
+            return true;
+        }
+
+        void Release()
+        {
+            ReleaseFence();
+            for (auto& query : m_queries) {
+                if (query)
+                    query->Release();
+                query = nullptr;
+            }
+            if (m_context)
+                m_context->Release();
+            m_context = nullptr;
+            m_issued = 0;
+        }
+
+        bool UsesFence() const { return m_fence != nullptr; }
+
+        Token Issue()
+        {
+            const Token token = ++m_issued;
+            if (m_fence)
+                m_context4->Signal(m_fence, token);
+            else
+                m_context->End(Query(token));
+            return token;
+        }
+
+        bool Done(Token token) const
+        {
+            if (m_fence)
+                return m_fence->GetCompletedValue() >= token;
+            return m_context->GetData(Query(token), nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+        }
+
+        void Wait(Token token)
+        {
+            if (Done(token))
+                return;
+
+            // The signal goes in after the present, so it can still be sitting in a command buffer that hasn't been submitted.
+            m_context->Flush();
+
+            if (m_fence && SUCCEEDED(m_fence->SetEventOnCompletion(token, m_event))) {
+                // The timeout only matters if the device is lost, when the fence reports everything as complete.
+                while (!Done(token))
+                    WaitForSingleObject(m_event, 100);
+                return;
+            }
+
+            Backoff backoff{};
+            while (!Done(token))
+                backoff.Pause();
+        }
+
+    private:
+        ID3D11DeviceContext* m_context = nullptr;
+        ID3D11DeviceContext4* m_context4 = nullptr;
+        ID3D11Fence* m_fence = nullptr;
+        HANDLE m_event = nullptr;
+        std::array<ID3D11Query*, MaxDepth + 2> m_queries{};    // Indexed by token, enough for every token outstanding at once
+        Token m_issued = 0;
+
+        ID3D11Query* Query(Token token) const { return m_queries[token % m_queries.size()]; }
+
+        void ReleaseFence()
+        {
+            if (m_event)
+                CloseHandle(m_event);
+            m_event = nullptr;
+            if (m_fence)
+                m_fence->Release();
+            m_fence = nullptr;
+            if (m_context4)
+                m_context4->Release();
+            m_context4 = nullptr;
+        }
+    };
+
+    struct PerformanceClock
+    {
+        double Now() const
+        {
+            static const double frequency = [] {
+                LARGE_INTEGER value{};
+                QueryPerformanceFrequency(&value);
+                return static_cast<double>(value.QuadPart);
+                }();
+            LARGE_INTEGER now{};
+            QueryPerformanceCounter(&now);
+            return static_cast<double>(now.QuadPart) / frequency;
+        }
+    };
+#endif
+}
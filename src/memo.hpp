@@ -0,0 +1,70 @@
+#pragma once
+
+// Memoisation for pure hook math.
+// Hooks like the FOV conversion run the same transcendental functions on the same inputs every frame. A result is cached
+// under the exact bits of every input it depends on, so a hit returns exactly what the computation would have.
+// Tables are meant to be thread_local, so there is no locking and a table is never shared between threads.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace Memo
+{
+    // Direct-mapped: each key has one slot, picked by hashing its bytes. A few slots cover callers that alternate
+    // between a handful of inputs (several cameras, for example) without evicting each other every call.
+    template<typename Key, typename Value, size_t Size = 8>
+    class Table
+    {
+        static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>);
+        static_assert(Size != 0 && (Size & (Size - 1)) == 0, "Size must be a power of two");
+
+    public:
+        // Returns the cached value for key, or calls compute() and caches what it returns.
+        // Keys are compared bitwise, so +0/-0 and different NaNs are separate entries rather than aliases.
+        template<typename Fn>
+        Value Get(const Key& key, Fn&& compute)
+        {
+            Entry& entry = m_entries[Hash(key) & (Size - 1)];
+            if (entry.bValid && memcmp(&entry.key, &key, sizeof(Key)) == 0) {
+                ++m_hits;
+                return entry.value;
+            }
+
+            ++m_misses;
+            entry.value = compute();
+            entry.key = key;
+            entry.bValid = true;
+            return entry.value;
+        }
+
+        void Clear() { m_entries = {}; }
+        uint64_t Hits() const { return m_hits; }
+        uint64_t Misses() const { return m_misses; }
+
+    private:
+        struct Entry
+        {
+            Key key{};
+            Value value{};
+            bool bValid = false;
+        };
+
+        std::array<Entry, Size> m_entries{};
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+
+        // FNV-1a over the key's bytes.
+        static size_t Hash(const Key& key)
+        {
+            unsigned char bytes[sizeof(Key)];
+            memcpy(bytes, &key, sizeof(Key));
+            uint32_t hash = 2166136261u;
+            for (unsigned char byte : bytes)
+                hash = (hash ^ byte) * 16777619u;
+            return hash;
+        }
+    };
+}
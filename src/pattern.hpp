@@ -0,0 +1,197 @@
+#pragma once
+
+// Pattern parsing and scanning, and the lookup order SignatureCache uses, kept free of Windows headers so
+// tools/synth_image.cpp can run the same code on Linux.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Memory
+{
+    // CSGOSimple's pattern scan
+    // https://github.com/OneshotGH/CSGOSimple-master/blob/master/CSGOSimple/helpers/utils.cpp
+    inline std::vector<int> PatternToBytes(const char* pattern)
+    {
+        auto bytes = std::vector<int>{};
+        auto start = const_cast<char*>(pattern);
+        auto end = const_cast<char*>(pattern) + strlen(pattern);
+
+        for (auto current = start; current < end; ++current) {
+            if (*current == '?') {
+                ++current;
+                if (*current == '?')
+                    ++current;
+                bytes.push_back(-1);
+            }
+            else {
+                bytes.push_back(strtoul(current, &current, 16));
+            }
+        }
+        return bytes;
+    }
+
+    inline std::uint8_t* PatternScanRange(std::uint8_t* scanBytes, size_t scanSize, const char* signature)
+    {
+        auto patternBytes = PatternToBytes(signature);
+
+        auto s = patternBytes.size();
+        auto d = patternBytes.data();
+
+        if (!scanBytes || scanSize < s)
+            return nullptr;
+
+        // A match may end on the last byte of the range.
+        for (size_t i = 0; i <= scanSize - s; ++i) {
+            bool found = true;
+            for (size_t j = 0; j < s; ++j) {
+                if (scanBytes[i + j] != d[j] && d[j] != -1) {
+                    found = false;
+                    break;
+                }
+            }
+            if (found) {
+                return &scanBytes[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // FNV-1a. Keys signatures in the cache and fingerprints the bytes a signature matched.
+    inline uint64_t Hash(const std::uint8_t* data, size_t size)
+    {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ data[i]) * 0x100000001B3ull;
+        return hash;
+    }
+
+    // True if signature matches at exactly rva.
+    inline bool VerifyAt(std::uint8_t* imageBytes, size_t sizeOfImage, uint32_t rva, size_t patternSize, const char* signature)
+    {
+        return rva + patternSize <= sizeOfImage && PatternScanRange(imageBytes + rva, patternSize, signature) == imageBytes + rva;
+    }
+
+    // A code section of the exe on disk.
+    struct CodeSection
+    {
+        std::uint8_t* raw;
+        size_t size;        // Bytes present in both the file and the image
+        uint32_t rva;
+    };
+
+    // First match in the exe's code sections on disk, as an RVA.
+    inline std::optional<uint32_t> PredictRVA(std::span<const CodeSection> sections, const char* signature)
+    {
+        for (const CodeSection& section : sections) {
+            if (std::uint8_t* match = PatternScanRange(section.raw, section.size, signature))
+                return section.rva + static_cast<uint32_t>(match - section.raw);
+        }
+        return std::nullopt;
+    }
+
+    enum class CacheOutcome
+    {
+        Exact,      // Matched at the last known RVA
+        Predicted,  // Matched at the RVA found by scanning the exe on disk
+        Window,     // Found within a window around the last known RVA, the only match there or the only one with the same bytes
+        FullScan,   // No usable cache entry, or not found near it
+        NotFound
+    };
+
+    struct CacheEntry
+    {
+        uint32_t rva;
+        uint64_t fingerprint;   // Hash of the bytes the signature matched, wildcards included
+    };
+
+    struct CacheLookup
+    {
+        std::uint8_t* found = nullptr;
+        CacheOutcome outcome = CacheOutcome::NotFound;
+        size_t window = 0;
+    };
+
+    // Tries the last known RVA, then the predicted RVA, then widening windows around the last known RVA, then the whole image.
+    // Each window only scans the ring the previous one didn't, and the full scan skips whatever the windows found empty, so a
+    // stale entry never costs more than one pass over the image.
+    inline CacheLookup LookupCached(std::uint8_t* imageBytes, size_t sizeOfImage, const char* signature, const std::optional<CacheEntry>& entry, const std::optional<uint32_t>& predicted)
+    {
+        const size_t patternSize = PatternToBytes(signature).size();
+        CacheLookup lookup{};
+        if (sizeOfImage < patternSize)
+            return lookup;
+
+        if (entry && VerifyAt(imageBytes, sizeOfImage, entry->rva, patternSize, signature)) {
+            lookup.found = imageBytes + entry->rva;
+            lookup.outcome = CacheOutcome::Exact;
+            return lookup;
+        }
+        if (predicted && VerifyAt(imageBytes, sizeOfImage, *predicted, patternSize, signature)) {
+            lookup.found = imageBytes + *predicted;
+            lookup.outcome = CacheOutcome::Predicted;
+            return lookup;
+        }
+
+        // Offsets are match starts. [scannedBegin, scannedEnd) has been searched and holds no match.
+        const size_t starts = sizeOfImage - patternSize + 1;
+        size_t scannedBegin = 0, scannedEnd = 0;
+        auto matchesIn = [&](size_t from, size_t to, std::vector<std::uint8_t*>& out) {
+            if (from >= to)
+                return;
+            std::uint8_t* limit = imageBytes + to + patternSize - 1;
+            for (auto hit = PatternScanRange(imageBytes + from, limit - (imageBytes + from), signature); hit; hit = PatternScanRange(hit + 1, limit - (hit + 1), signature))
+                out.push_back(hit);
+            };
+
+        if (entry && entry->rva < starts) {
+            std::vector<std::uint8_t*> hits{};
+            scannedBegin = scannedEnd = entry->rva;
+            for (size_t window : { 0x1000ull, 0x10000ull, 0x100000ull, 0x1000000ull }) {
+                const size_t begin = entry->rva - std::min<size_t>(window, entry->rva);
+                const size_t end = std::min<size_t>(starts, entry->rva + window + 1);
+                matchesIn(begin, scannedBegin, hits);
+                matchesIn(scannedEnd, end, hits);
+                scannedBegin = begin;
+                scannedEnd = end;
+                if (hits.empty())
+                    continue;
+
+                // The first window with anything in it decides. Code that moved also has new rel32 and RIP displacements under
+                // the wildcards, so a lone match is taken whatever its bytes. Several are only told apart by a single one still
+                // having last time's bytes, otherwise the full scan picks as it would without a cache.
+                std::uint8_t* pick = (hits.size() == 1) ? hits[0] : nullptr;
+                if (!pick) {
+                    size_t same = 0;
+                    for (std::uint8_t* hit : hits) {
+                        if (Hash(hit, patternSize) == entry->fingerprint) {
+                            pick = hit;
+                            ++same;
+                        }
+                    }
+                    if (same != 1)
+                        pick = nullptr;
+                }
+                if (pick) {
+                    lookup.found = pick;
+                    lookup.outcome = CacheOutcome::Window;
+                    lookup.window = window;
+                    return lookup;
+                }
+                scannedBegin = scannedEnd = 0;
+                break;
+            }
+        }
+
+        lookup.found = PatternScanRange(imageBytes, scannedBegin + patternSize - 1, signature);
+        if (!lookup.found)
+            lookup.found = PatternScanRange(imageBytes + scannedEnd, sizeOfImage - scannedEnd, signature);
+        lookup.outcome = lookup.found ? CacheOutcome::FullScan : CacheOutcome::NotFound;
+        return lookup;
+    }
+}
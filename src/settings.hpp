@@ -0,0 +1,130 @@
+#pragma once
+
+// The fix's ini settings and the schema that loads them.
+// Kept out of dllmain.cpp and free of Windows headers so tools/config_check.cpp fuzzes the real schema, ranges and rounding.
+
+#include <atomic>
+
+#include "benchmark.hpp"
+#include "config.hpp"
+
+// Ini variables
+inline bool bFixResolution;
+inline bool bFixAspect;
+inline bool bFixFOV;
+inline bool bFixHUD;
+inline bool bFixMovies;
+inline bool bSkipLogos;
+inline bool bSkipMovie;
+inline bool bMenuFPSCap;
+inline std::atomic<float> fAOResolutionScale{ 1.00f };      // Atomic since benchmark profiles change these while hooks read them
+inline float fGameplayFOVMulti = 1.00f;
+inline std::atomic<float> fLODDistance{ 10.00f };
+inline bool bFixAnalog;
+inline std::atomic<float> fCustomResScale{ 1.00f };
+inline bool bDisableOutlines;
+inline int iShadowResolution = 2048;
+inline bool bForceControllerIcons;
+inline bool bDisableCameraShake;
+inline bool bGameWindow;
+inline bool bPauseOnFocusLoss;
+inline bool bInputPolling;
+inline int iInputPollingRate = 1000;
+inline int iInputDeadzone = 0;
+inline float fInputSmoothing = 0.00f;
+inline bool bLatencyLimiter;
+inline int iLatencyMaxQueuedFrames = 1;
+inline bool bBenchmark;
+inline int iBenchmarkProfileKey = 0x78;   // VK_F9
+inline int iBenchmarkRunKey = 0x79;       // VK_F10
+inline int iBenchmarkSegments = 6;
+inline int iBenchmarkSegmentSeconds = 10;
+inline bool bThreadScheduling;
+inline int iMainCores = 1;
+inline int iRenderCores = 1;
+inline int iAudioCores = 0;
+inline int iWorkerCores = 0;
+inline int iFixCores = 2;
+inline int iMainPriority = 0;
+inline int iRenderPriority = 0;
+inline int iAudioPriority = 0;
+inline int iWorkerPriority = 0;
+inline int iFixPriority = -2;
+inline bool bTrace;
+inline bool bCapture;
+inline bool bStartupTimeline;
+inline int iCaptureCalls = 10000;
+
+// Settings that can be switched while the game is running, for benchmark profiles.
+struct SettingsProfile
+{
+    bool bEnabled;
+    float fAOResolutionScale;
+    float fLODDistance;
+    float fCustomResScale;
+};
+inline SettingsProfile BenchmarkProfiles[Benchmark::MaxProfiles] = { { true, 1.00f, 10.00f, 1.00f }, { true, 1.00f, 10.00f, 1.00f }, { false, 1.00f, 10.00f, 1.00f } };
+inline const char* sBenchmarkProfileNames[Benchmark::MaxProfiles] = { "Profile A", "Profile B", "Profile C" };
+inline bool bTelemetry;
+
+// Config schema. Missing or unreadable keys fall back to the default, out of range values are clamped.
+inline constexpr Config::Setting ConfigSchema[] = {
+    { "Fix Resolution", "Enabled", "bFixResolution", Config::Type::Bool, &bFixResolution, 0 },
+    { "Fix Aspect Ratio", "Enabled", "bFixAspect", Config::Type::Bool, &bFixAspect, 0 },
+    { "Fix FOV", "Enabled", "bFixFOV", Config::Type::Bool, &bFixFOV, 0 },
+    { "Fix HUD", "Enabled", "bFixHUD", Config::Type::Bool, &bFixHUD, 0 },
+    { "Fix Movies", "Enabled", "bFixMovies", Config::Type::Bool, &bFixMovies, 0 },
+    { "Intro Skip", "SkipLogos", "bSkipLogos", Config::Type::Bool, &bSkipLogos, 0 },
+    { "Intro Skip", "SkipMovie", "bSkipMovie", Config::Type::Bool, &bSkipMovie, 0 },
+    { "Disable Menu FPS Cap", "Enabled", "bMenuFPSCap", Config::Type::Bool, &bMenuFPSCap, 0 },
+    { "Fix Analog Movement", "Enabled", "bFixAnalog", Config::Type::Bool, &bFixAnalog, 0 },
+    { "Gameplay FOV", "Multiplier", "fGameplayFOVMulti", Config::Type::Float, &fGameplayFOVMulti, 1.00, 0.10, 3.00 },
+    { "Ambient Occlusion", "Resolution", "fAOResolutionScale", Config::Type::AtomicFloat, &fAOResolutionScale, 1.00, 0.10, 1.00 },
+    { "LOD", "Distance", "fLODDistance", Config::Type::AtomicFloat, &fLODDistance, 10.00, 1.00, 100.00 },
+    { "Custom Resolution Scale", "Resolution", "fCustomResScale", Config::Type::AtomicFloat, &fCustomResScale, 1.00, 0.10, 4.00 },
+    { "Disable Outlines", "Enabled", "bDisableOutlines", Config::Type::Bool, &bDisableOutlines, 0 },
+    { "Shadow Quality", "Resolution", "iShadowResolution", Config::Type::Int, &iShadowResolution, 2048, 64, 16384, 64 },
+    { "Force Controller Icons", "Enabled", "bForceControllerIcons", Config::Type::Bool, &bForceControllerIcons, 0 },
+    { "Disable Camera Shake", "Enabled", "bDisableCameraShake", Config::Type::Bool, &bDisableCameraShake, 0 },
+    { "Game Window", "Enabled", "bGameWindow", Config::Type::Bool, &bGameWindow, 0 },
+    { "Game Window", "PauseOnFocusLoss", "bPauseOnFocusLoss", Config::Type::Bool, &bPauseOnFocusLoss, 0 },
+    { "Input Polling", "Enabled", "bInputPolling", Config::Type::Bool, &bInputPolling, 0 },
+    { "Input Polling", "Rate", "iInputPollingRate", Config::Type::Int, &iInputPollingRate, 1000, 125, 2000 },
+    { "Input Polling", "Deadzone", "iInputDeadzone", Config::Type::Int, &iInputDeadzone, 0, 0, 32766 },
+    { "Input Polling", "Smoothing", "fInputSmoothing", Config::Type::Float, &fInputSmoothing, 0.00, 0.00, 0.90 },
+    { "Latency Limiter", "Enabled", "bLatencyLimiter", Config::Type::Bool, &bLatencyLimiter, 0 },
+    { "Latency Limiter", "MaxQueuedFrames", "iLatencyMaxQueuedFrames", Config::Type::Int, &iLatencyMaxQueuedFrames, 1, 1, 3 },
+    { "Benchmark", "Enabled", "bBenchmark", Config::Type::Bool, &bBenchmark, 0 },
+    { "Benchmark", "ProfileKey", "iBenchmarkProfileKey", Config::Type::Int, &iBenchmarkProfileKey, 0x78, 1, 254 },
+    { "Benchmark", "RunKey", "iBenchmarkRunKey", Config::Type::Int, &iBenchmarkRunKey, 0x79, 1, 254 },
+    { "Benchmark", "Segments", "iBenchmarkSegments", Config::Type::Int, &iBenchmarkSegments, 6, 2, 100 },
+    { "Benchmark", "SegmentSeconds", "iBenchmarkSegmentSeconds", Config::Type::Int, &iBenchmarkSegmentSeconds, 10, 2, 600 },
+    { "Benchmark Profile A", "Enabled", "bProfileAEnabled", Config::Type::Bool, &BenchmarkProfiles[0].bEnabled, 1 },
+    { "Benchmark Profile A", "AOResolution", "fProfileAAOResolutionScale", Config::Type::Float, &BenchmarkProfiles[0].fAOResolutionScale, 1.00, 0.10, 1.00 },
+    { "Benchmark Profile A", "LODDistance", "fProfileALODDistance", Config::Type::Float, &BenchmarkProfiles[0].fLODDistance, 10.00, 1.00, 100.00 },
+    { "Benchmark Profile A", "CustomResScale", "fProfileACustomResScale", Config::Type::Float, &BenchmarkProfiles[0].fCustomResScale, 1.00, 0.10, 4.00 },
+    { "Benchmark Profile B", "Enabled", "bProfileBEnabled", Config::Type::Bool, &BenchmarkProfiles[1].bEnabled, 1 },
+    { "Benchmark Profile B", "AOResolution", "fProfileBAOResolutionScale", Config::Type::Float, &BenchmarkProfiles[1].fAOResolutionScale, 1.00, 0.10, 1.00 },
+    { "Benchmark Profile B", "LODDistance", "fProfileBLODDistance", Config::Type::Float, &BenchmarkProfiles[1].fLODDistance, 10.00, 1.00, 100.00 },
+    { "Benchmark Profile B", "CustomResScale", "fProfileBCustomResScale", Config::Type::Float, &BenchmarkProfiles[1].fCustomResScale, 1.00, 0.10, 4.00 },
+    { "Benchmark Profile C", "Enabled", "bProfileCEnabled", Config::Type::Bool, &BenchmarkProfiles[2].bEnabled, 0 },
+    { "Benchmark Profile C", "AOResolution", "fProfileCAOResolutionScale", Config::Type::Float, &BenchmarkProfiles[2].fAOResolutionScale, 1.00, 0.10, 1.00 },
+    { "Benchmark Profile C", "LODDistance", "fProfileCLODDistance", Config::Type::Float, &BenchmarkProfiles[2].fLODDistance, 10.00, 1.00, 100.00 },
+    { "Benchmark Profile C", "CustomResScale", "fProfileCCustomResScale", Config::Type::Float, &BenchmarkProfiles[2].fCustomResScale, 1.00, 0.10, 4.00 },
+    { "Thread Scheduling", "Enabled", "bThreadScheduling", Config::Type::Bool, &bThreadScheduling, 0 },
+    { "Thread Scheduling", "MainCores", "iMainCores", Config::Type::Int, &iMainCores, 1, 0, 2 },
+    { "Thread Scheduling", "RenderCores", "iRenderCores", Config::Type::Int, &iRenderCores, 1, 0, 2 },
+    { "Thread Scheduling", "AudioCores", "iAudioCores", Config::Type::Int, &iAudioCores, 0, 0, 2 },
+    { "Thread Scheduling", "WorkerCores", "iWorkerCores", Config::Type::Int, &iWorkerCores, 0, 0, 2 },
+    { "Thread Scheduling", "FixCores", "iFixCores", Config::Type::Int, &iFixCores, 2, 0, 2 },
+    { "Thread Scheduling", "MainPriority", "iMainPriority", Config::Type::Int, &iMainPriority, 0, -2, 2 },
+    { "Thread Scheduling", "RenderPriority", "iRenderPriority", Config::Type::Int, &iRenderPriority, 0, -2, 2 },
+    { "Thread Scheduling", "AudioPriority", "iAudioPriority", Config::Type::Int, &iAudioPriority, 0, -2, 2 },
+    { "Thread Scheduling", "WorkerPriority", "iWorkerPriority", Config::Type::Int, &iWorkerPriority, 0, -2, 2 },
+    { "Thread Scheduling", "FixPriority", "iFixPriority", Config::Type::Int, &iFixPriority, -2, -2, 2 },
+    { "Trace", "Enabled", "bTrace", Config::Type::Bool, &bTrace, 0 },
+    { "Startup Timeline", "Enabled", "bStartupTimeline", Config::Type::Bool, &bStartupTimeline, 0 },
+    { "Capture", "Enabled", "bCapture", Config::Type::Bool, &bCapture, 0 },
+    { "Capture", "Calls", "iCaptureCalls", Config::Type::Int, &iCaptureCalls, 10000, 1, 1000000 },
+    { "Telemetry", "Enabled", "bTelemetry", Config::Type::Bool, &bTelemetry, 0 },
+};
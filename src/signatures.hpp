@@ -0,0 +1,76 @@
+#pragma once
+
+// Every signature the fix scans for, in the order they are used.
+// Kept in one place so tools and the on-disk pre-resolver can walk the full set.
+namespace Signatures
+{
+    inline constexpr const char* ShadowResolution = "C7 ?? ?? 00 08 00 00 C7 ?? ?? 00 08 00 00 C7 ?? ?? ?? ?? ?? ?? C7 ?? ?? 01 00 00 00";
+    inline constexpr const char* ShadowTexShift = "41 ?? ?? 48 ?? ?? ?? 48 ?? ?? FF ?? ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ?? 4C ?? ?? ?? ??";
+    inline constexpr const char* CSMSplits = "8B ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? ?? C4 ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? 48 ?? ?? ??";
+    inline constexpr const char* ResolutionScale = "8B ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? 44 ?? ?? ??";
+    inline constexpr const char* AOResolution = "8B ?? 48 ?? ?? ?? ?? ?? ?? 48 ?? ?? 74 ?? E8 ?? ?? ?? ?? 41 ?? 00 40 00 00 41 ?? 16 00 00 00";
+    inline constexpr const char* LODDistance = "C5 ?? ?? ?? ?? ?? ? ?? C5 ?? ?? ?? ?? ?? 73 ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? 72 ?? C5 ?? ?? ?? ?? 73 ??";
+    inline constexpr const char* FoliageDistance = "C5 ?? ?? ?? 73 ?? C5 ?? ?? ?? EB ?? C5 ?? ?? ?? ?? ?? ?? ?? EB ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? 77 ??";
+    inline constexpr const char* OutlineShader = "C7 ?? ?? ?? ?? ?? 0F 00 00 00 C6 ?? ?? ?? ?? ?? 01 C6 ?? ?? ?? ?? ?? 01";
+    inline constexpr const char* IntroSkip = "83 ?? ?? 0F 87 ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ?? 8B ?? ?? ?? ?? ?? ?? 48 ?? ?? FF ?? BA 01 00 00 00 48 ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ??";
+    inline constexpr const char* DemoIntroSkip = "83 ?? 49 0F 87 ?? ?? ?? ?? 48 8D ?? ?? ?? ?? ?? 8B ?? ?? ?? ?? ?? ?? 48 ?? ??";
+    inline constexpr const char* CurrentResolution = "4C ?? ?? ?? ?? ?? ?? ?? 8B ?? 48 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? 8D ?? ?? C1 ?? 04";
+    inline constexpr const char* ResolutionFix = "C5 ?? ?? ?? 89 ?? ?? ?? ?? ?? C5 ?? ?? ?? 89 ?? ?? ?? ?? ?? 85 ?? 7E ??";
+    inline constexpr const char* ShadowAspectRatio = "48 ?? ?? ?? C5 ?? ?? ?? ?? ?? E8 ?? ?? ?? ?? 8B ?? ?? ?? ?? ?? 4C ?? ?? ?? ?? ??";
+    inline constexpr const char* CameraPaneAspectRatio = "48 ?? ?? E8 ?? ?? ?? ?? C5 ?? ?? ?? ?? 48 ?? ?? E8 ?? ?? ?? ?? C5 ?? ?? ?? ?? 48 ?? ?? E8 ?? ?? ?? ?? 4C ?? ??";
+    inline constexpr const char* CameraPane = "41 ?? ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? 41 0F ?? ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? ?? ?? ??";
+    inline constexpr const char* GlobalFOV = "E9 ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? E8 ?? ?? ?? ?? C5 ?? ?? ??";
+    inline constexpr const char* GameplayFOV = "45 ?? ?? 48 ?? ?? C4 ?? ?? ?? ?? E8 ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? C4 ?? ?? ?? ?? C5 ?? ?? ??";
+    inline constexpr const char* HUDWidth = "F3 0F ?? ?? ?? ?? ?? ?? E8 ?? ?? ?? ?? F3 0F ?? ?? 66 0F ?? ?? 0F ?? ?? F3 0F ?? ??";
+    inline constexpr const char* Fades = "F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? ?? ?? ?? ?? 89 ?? ?? 0F ?? ?? ?? ?? ?? ?? C1 ?? 08";
+    inline constexpr const char* PauseCapture = "48 ?? ?? ?? ?? 48 ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? ?? 5F 5E 5B C3";
+    inline constexpr const char* HUDOffset = "F2 0F ?? ?? ?? ?? 0F ?? ?? 0F ?? ?? ?? ?? 45 ?? ?? 74 ?? 48 ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? 48 ?? ?? FF ?? ??";
+    inline constexpr const char* HUDOffsetClip = "66 0F ?? ?? ?? ?? 0F ?? ?? 0F ?? ?? ?? ?? 45 ?? ?? 74 ?? 48 ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? 48 ?? ?? FF ?? ??";
+    inline constexpr const char* ScreenPosHor = "C5 ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? 48 8B ?? ?? ?? C5 ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? ?? ??";
+    inline constexpr const char* ScreenPosVert = "C5 ?? ?? ?? C5 ?? ?? ?? 48 ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? ?? ?? ?? ?? C5 ?? ?? ?? C5 ?? ?? ??";
+    inline constexpr const char* ElementSize = "45 ?? ?? 8B ?? ?? 0F ?? ?? ?? ?? 89 ?? ?? 8B ?? ?? ?? 89 ?? ??";
+    inline constexpr const char* FadeWipe = "48 ?? ?? B2 01 48 ?? ?? FF ?? ?? ?? ?? ?? 48 ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ?? 48 ?? ?? 0F 84 ?? ?? ?? ??";
+    inline constexpr const char* Movies = "8B ?? ?? 48 ?? ?? ?? 48 ?? ?? ?? ?? 4C ?? ?? ?? ?? 4C ?? ?? ?? ?? F3 0F ?? ?? ?? ?? E8 ?? ?? ?? ??";
+    inline constexpr const char* FramerateCap = "89 ?? ?? ?? ?? ?? 8B ?? C7 ?? ?? ?? ?? ?? ?? ?? 85 ?? 75 ?? 48 ?? ?? ?? ?? ?? ?? 00";
+    inline constexpr const char* XInputGetState = "3D ?? ?? ?? ?? 8D ?? ?? ?? ?? ?? C5 ?? ?? ?? 41 ?? ?? ?? 3D ?? ?? ?? ?? C5 ?? ?? ?? 0F ?? ?? ?? ??";
+    inline constexpr const char* KeyboardIcons = "84 ?? 74 ?? C7 ?? ?? ?? ?? ?? 02 00 00 00 48 ?? ?? ?? 5B C3";
+    inline constexpr const char* MouseIcons1 = "E8 ?? ?? ?? ?? 48 ?? ?? ?? 5B E9 ?? ?? ?? ?? C7 ?? ?? ?? ?? ?? 01 00 00 00 48 ?? ?? ?? 5B C3";
+    inline constexpr const char* MouseIcons2 = "C7 ?? ?? ?? ?? ?? 01 00 00 00 E8 ?? ?? ?? ?? 83 ?? 01 75 ?? 0F ?? ?? E8 ?? ?? ?? ?? E8 ?? ?? ?? ?? 85 ?? 0F 85 ?? ?? ?? ?? 4C ?? ?? ?? ??";
+    inline constexpr const char* CameraShake = "41 ?? ?? 05 44 89 ?? ?? ?? ?? ?? C5 ?? ?? ?? 02";
+
+    inline constexpr const char* All[] = {
+        ShadowResolution,
+        ShadowTexShift,
+        CSMSplits,
+        ResolutionScale,
+        AOResolution,
+        LODDistance,
+        FoliageDistance,
+        OutlineShader,
+        IntroSkip,
+        DemoIntroSkip,
+        CurrentResolution,
+        ResolutionFix,
+        ShadowAspectRatio,
+        CameraPaneAspectRatio,
+        CameraPane,
+        GlobalFOV,
+        GameplayFOV,
+        HUDWidth,
+        Fades,
+        PauseCapture,
+        HUDOffset,
+        HUDOffsetClip,
+        ScreenPosHor,
+        ScreenPosVert,
+        ElementSize,
+        FadeWipe,
+        Movies,
+        FramerateCap,
+        XInputGetState,
+        KeyboardIcons,
+        MouseIcons1,
+        MouseIcons2,
+        CameraShake,
+    };
+}
@@ -8,4 +8,12 @@
 #include <iostream>
 #include <inttypes.h>
 #include <filesystem>
-#include <string>
\ No newline at end of file
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+// Code emitted for RegisterLoadHook, kept free of SafetyHook and Windows headers so tools/hook_bench.cpp can run the
+// same stub on Linux.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Hooks
+{
+    // Registers a RegisterLoadHook can write to.
+    // General purpose registers are written in full, XMM registers only have their lowest float replaced.
+    enum class Register : uint8_t
+    {
+        RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+        R8, R9, R10, R11, R12, R13, R14, R15,
+        XMM0, XMM1, XMM2, XMM3, XMM4, XMM5, XMM6, XMM7,
+        XMM8, XMM9, XMM10, XMM11, XMM12, XMM13, XMM14, XMM15
+    };
+
+    struct RegisterLoadStub
+    {
+        std::vector<uint8_t> code{};
+        size_t trampolineSlot = 0;  // Offset of the 8 byte address the stub jumps to when it's done
+    };
+
+    // Loads *source into reg and jumps to whatever address is stored at trampolineSlot.
+    // If condition is set, the load is skipped while *condition is false. RSP can't be loaded.
+    inline RegisterLoadStub EmitRegisterLoad(Register reg, const void* source, const bool* condition = nullptr)
+    {
+        RegisterLoadStub stub{};
+        auto& code = stub.code;
+
+        const uint8_t regId = static_cast<uint8_t>(reg);
+        const bool isXMM = regId >= static_cast<uint8_t>(Register::XMM0);
+        const uint8_t regNum = isXMM ? regId - static_cast<uint8_t>(Register::XMM0) : regId;
+
+        // Scratch register for the address of source/condition. RCX if we're loading RAX.
+        const uint8_t scratch = (reg == Register::RAX) ? 1 : 0;
+
+        auto emitImm64 = [&](uint64_t value) {
+            for (int i = 0; i < 8; ++i)
+                code.push_back(static_cast<uint8_t>(value >> (i * 8)));
+            };
+
+        code.push_back(0x50 + scratch);                                 // push scratch
+
+        size_t skipJump = 0;
+        if (condition) {
+            code.push_back(0x9C);                                       // pushfq
+            code.push_back(0x48); code.push_back(0xB8 + scratch);       // mov scratch, condition
+            emitImm64(reinterpret_cast<uint64_t>(condition));
+            code.push_back(0x80); code.push_back(0x38 | scratch); code.push_back(0x00); // cmp byte ptr [scratch], 0
+            code.push_back(0x74); code.push_back(0x00);                 // je skip
+            skipJump = code.size() - 1;
+        }
+
+        code.push_back(0x48); code.push_back(0xB8 + scratch);           // mov scratch, source
+        emitImm64(reinterpret_cast<uint64_t>(source));
+
+        if (isXMM) {
+            // insertps xmmN, dword ptr [scratch], 0
+            // Legacy encoding so the upper lanes (and upper YMM bits) are preserved, same as a mid hook.
+            code.push_back(0x66);
+            if (regNum >= 8)
+                code.push_back(0x44);
+            code.push_back(0x0F); code.push_back(0x3A); code.push_back(0x21);
+            code.push_back(static_cast<uint8_t>(((regNum & 7) << 3) | scratch));
+            code.push_back(0x00);
+        }
+        else {
+            // mov reg, qword ptr [scratch]
+            code.push_back(regNum >= 8 ? 0x4C : 0x48);
+            code.push_back(0x8B);
+            code.push_back(static_cast<uint8_t>(((regNum & 7) << 3) | scratch));
+        }
+
+        if (condition) {
+            code[skipJump] = static_cast<uint8_t>(code.size() - (skipJump + 1));
+            code.push_back(0x9D);                                       // popfq
+        }
+
+        code.push_back(0x58 + scratch);                                 // pop scratch
+        code.push_back(0xFF); code.push_back(0x25);                     // jmp qword ptr [rip+0]
+        code.push_back(0x00); code.push_back(0x00); code.push_back(0x00); code.push_back(0x00);
+        stub.trampolineSlot = code.size();
+        emitImm64(0);                                                   // trampoline address, filled in once the hook exists
+        return stub;
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+// Live telemetry.
+// A fixed-layout block in named shared memory, republished once per frame from the Present hook so overlays and loggers
+// can read what the fix is doing without tailing the log. Hooks only bump counters, and publishing makes no syscalls.
+// The layout below is shared with tools/telemetry_reader.cpp and must stay portable.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <string>
+#endif
+
+namespace Telemetry
+{
+    inline constexpr char Magic[8] = { 'M', 'F', 'T', 'E', 'L', 'E', 'M', '\0' };
+    inline constexpr uint32_t Version = 1;
+    inline constexpr size_t HookCount = 4;      // Trace::HookCount, in the same order as Trace::Hook
+    inline constexpr const char* SharedMemoryName = "MetaphorFix.Telemetry";
+
+    struct Snapshot
+    {
+        uint64_t timestamp;         // QueryPerformanceCounter (CLOCK_MONOTONIC nanoseconds from the stand-in publisher)
+        uint64_t timerFrequency;
+        uint64_t updates;           // Number of times the block has been published
+        int32_t resX;
+        int32_t resY;
+        float aspectRatio;
+        float hudWidth;
+        float hudHeight;
+        int32_t resScaleOption;     // In-game option, 0 = 200% ... 6 = 50%
+        float resScale;             // Effective scale, including a custom resolution scale
+        int32_t aoResX;             // Last ambient occlusion render target size, 0 until the hook has run
+        int32_t aoResY;
+        float lodDistance;
+        uint64_t hookHits[HookCount];
+    };
+    static_assert(sizeof(Snapshot) % sizeof(uint64_t) == 0);
+    static_assert(sizeof(Snapshot) == 96);
+
+    // Single-writer seqlock. The sequence is odd while the publisher is writing.
+    struct Block
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t snapshotSize;
+        uint32_t sequence;
+        uint32_t publisherId;       // Process id of the game
+        uint64_t reserved[2];
+        uint64_t words[sizeof(Snapshot) / sizeof(uint64_t)];
+    };
+    static_assert(sizeof(Block) == 40 + sizeof(Snapshot));
+
+    inline void Initialise(Block& block, uint32_t publisherId)
+    {
+        memset(&block, 0, sizeof(Block));
+        block.version = Version;
+        block.snapshotSize = sizeof(Snapshot);
+        block.publisherId = publisherId;
+        std::atomic_thread_fence(std::memory_order_release);
+        // Magic last, so a reader never sees a valid magic with the rest unset.
+        memcpy(block.magic, Magic, sizeof(Magic));
+    }
+
+    inline void Publish(Block& block, const Snapshot& snapshot)
+    {
+        uint64_t words[sizeof(Snapshot) / sizeof(uint64_t)];
+        memcpy(words, &snapshot, sizeof(words));
+
+        std::atomic_ref<uint32_t> sequence(block.sequence);
+        const uint32_t before = sequence.load(std::memory_order_relaxed);
+        sequence.store(before + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < std::size(words); ++i)
+            std::atomic_ref<uint64_t>(block.words[i]).store(words[i], std::memory_order_relaxed);
+        sequence.store(before + 2, std::memory_order_release);
+    }
+
+    // Returns false if the block isn't initialised, has a different layout, or the publisher kept writing for every attempt.
+    inline bool Read(Block& block, Snapshot& snapshot, int attempts = 100)
+    {
+        if (memcmp(block.magic, Magic, sizeof(Magic)) != 0 || block.version != Version || block.snapshotSize != sizeof(Snapshot))
+            return false;
+
+        std::atomic_ref<uint32_t> sequence(block.sequence);
+        uint64_t words[sizeof(Snapshot) / sizeof(uint64_t)];
+        for (int attempt = 0; attempt < attempts; ++attempt) {
+            const uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1)
+                continue;
+            for (size_t i = 0; i < std::size(words); ++i)
+                words[i] = std::atomic_ref<uint64_t>(block.words[i]).load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                memcpy(&snapshot, words, sizeof(words));
+                return true;
+            }
+        }
+        return false;
+    }
+
+#ifdef _WIN32
+    // Creates the named mapping (Local\MetaphorFix.Telemetry). The handle is kept open for the life of the process.
+    inline Block* Open()
+    {
+        HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(Block), (std::string("Local\\") + SharedMemoryName).c_str());
+        if (!mapping)
+            return nullptr;
+
+        auto* block = static_cast<Block*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(Block)));
+        if (!block) {
+            CloseHandle(mapping);
+            return nullptr;
+        }
+
+        Initialise(*block, GetCurrentProcessId());
+        return block;
+    }
+#endif
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+// Thread classification and core topology for the thread scheduling option.
+// The classification and mask logic only works on plain data, so it can be exercised with a made-up topology.
+// The Windows side enumerates the process's threads and applies affinity masks and priorities.
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <tlhelp32.h>
+#endif
+
+namespace Threads
+{
+    enum class Role : uint8_t
+    {
+        Unknown,    // Left alone
+        Main,       // Started at the exe's entry point
+        Render,
+        Audio,
+        Worker,     // Job system / task workers
+        Fix         // Started inside this DLL (std::thread too, with the static CRT the release build uses)
+    };
+
+    inline const char* RoleName(Role role)
+    {
+        switch (role) {
+        case Role::Main: return "Main";
+        case Role::Render: return "Render";
+        case Role::Audio: return "Audio";
+        case Role::Worker: return "Worker";
+        case Role::Fix: return "Fix";
+        default: return "Unknown";
+        }
+    }
+
+    // Which cores a role is allowed on.
+    enum class Cores : uint8_t
+    {
+        Any = 0,
+        Performance = 1,
+        Efficiency = 2
+    };
+
+    struct ThreadInfo
+    {
+        uint32_t id;
+        std::string description;    // SetThreadDescription name, UTF-8
+        std::string module;         // File name of the module containing the start address, lower case
+        bool atEntryPoint;          // Start address is the exe's entry point
+        bool inThisModule;          // Start address is inside this DLL
+    };
+
+    // One entry per physical core. Masks are relative to processor group 0.
+    struct Core
+    {
+        uint64_t mask;
+        uint8_t efficiencyClass;    // Higher is faster
+    };
+
+    struct Topology
+    {
+        std::vector<Core> cores;
+
+        bool IsHybrid() const
+        {
+            return std::any_of(cores.begin(), cores.end(), [&](const Core& core) { return core.efficiencyClass != cores.front().efficiencyClass; });
+        }
+
+        uint64_t All() const
+        {
+            uint64_t mask = 0;
+            for (const auto& core : cores)
+                mask |= core.mask;
+            return mask;
+        }
+
+        // Cores of the highest (Performance) or lowest (Efficiency) efficiency class.
+        uint64_t Mask(Cores kind) const
+        {
+            if (kind == Cores::Any || !IsHybrid())
+                return All();
+
+            auto [lowest, highest] = std::minmax_element(cores.begin(), cores.end(), [](const Core& a, const Core& b) { return a.efficiencyClass < b.efficiencyClass; });
+            const uint8_t wanted = (kind == Cores::Performance) ? highest->efficiencyClass : lowest->efficiencyClass;
+            uint64_t mask = 0;
+            for (const auto& core : cores) {
+                if (core.efficiencyClass == wanted)
+                    mask |= core.mask;
+            }
+            return mask;
+        }
+    };
+
+    inline bool ContainsNoCase(std::string_view text, std::string_view needle)
+    {
+        auto lower = [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c; };
+        return std::search(text.begin(), text.end(), needle.begin(), needle.end(), [&](char a, char b) { return lower(a) == lower(b); }) != text.end();
+    }
+
+    inline Role Classify(const ThreadInfo& thread)
+    {
+        if (thread.inThisModule)
+            return Role::Fix;
+        if (thread.atEntryPoint)
+            return Role::Main;
+
+        static constexpr std::pair<std::string_view, Role> descriptionRules[] = {
+            { "render", Role::Render }, { "rhi", Role::Render }, { "present", Role::Render },
+            { "audio", Role::Audio }, { "sound", Role::Audio }, { "xaudio", Role::Audio }, { "atom", Role::Audio },
+            { "worker", Role::Worker }, { "job", Role::Worker }, { "task", Role::Worker }
+        };
+        for (const auto& [keyword, role] : descriptionRules) {
+            if (ContainsNoCase(thread.description, keyword))
+                return role;
+        }
+
+        static constexpr std::pair<std::string_view, Role> moduleRules[] = {
+            { "xaudio2", Role::Audio }, { "audioses", Role::Audio }
+        };
+        for (const auto& [keyword, role] : moduleRules) {
+            if (ContainsNoCase(thread.module, keyword))
+                return role;
+        }
+        return Role::Unknown;
+    }
+
+#ifdef _WIN32
+    inline Topology QueryTopology()
+    {
+        Topology topology{};
+        DWORD size = 0;
+        GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &size);
+        std::vector<uint8_t> buffer(size);
+        if (!GetLogicalProcessorInformationEx(RelationProcessorCore, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &size))
+            return topology;
+
+        for (DWORD offset = 0; offset < size;) {
+            auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+            if (info->Relationship == RelationProcessorCore && info->Processor.GroupCount > 0 && info->Processor.GroupMask[0].Group == 0)
+                topology.cores.push_back({ static_cast<uint64_t>(info->Processor.GroupMask[0].Mask), info->Processor.EfficiencyClass });
+            offset += info->Size;
+        }
+        return topology;
+    }
+
+    inline std::vector<ThreadInfo> Enumerate(HMODULE exeModule, HMODULE thisModule)
+    {
+        using NtQueryInformationThread_t = LONG(NTAPI*)(HANDLE, ULONG, PVOID, ULONG, PULONG);
+        using GetThreadDescription_t = HRESULT(WINAPI*)(HANDLE, PWSTR*);
+        static auto NtQueryInformationThread_fn = reinterpret_cast<NtQueryInformationThread_t>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtQueryInformationThread"));
+        static auto GetThreadDescription_fn = reinterpret_cast<GetThreadDescription_t>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "GetThreadDescription"));
+        constexpr ULONG ThreadQuerySetWin32StartAddress = 9;
+
+        auto dosHeader = (PIMAGE_DOS_HEADER)exeModule;
+        auto ntHeaders = (PIMAGE_NT_HEADERS)((uint8_t*)exeModule + dosHeader->e_lfanew);
+        const uintptr_t entryPoint = (uintptr_t)exeModule + ntHeaders->OptionalHeader.AddressOfEntryPoint;
+
+        std::vector<ThreadInfo> threads{};
+        HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+        if (snapshot == INVALID_HANDLE_VALUE)
+            return threads;
+
+        THREADENTRY32 entry{ .dwSize = sizeof(THREADENTRY32) };
+        for (BOOL ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry)) {
+            if (entry.th32OwnerProcessID != GetCurrentProcessId())
+                continue;
+
+            HANDLE thread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION | THREAD_QUERY_INFORMATION, FALSE, entry.th32ThreadID);
+            if (!thread)
+                continue;
+
+            ThreadInfo info{ .id = entry.th32ThreadID };
+
+            PWSTR description = nullptr;
+            if (GetThreadDescription_fn && SUCCEEDED(GetThreadDescription_fn(thread, &description)) && description) {
+                int length = WideCharToMultiByte(CP_UTF8, 0, description, -1, nullptr, 0, nullptr, nullptr);
+                if (length > 1) {
+                    info.description.resize(length - 1);
+                    WideCharToMultiByte(CP_UTF8, 0, description, -1, info.description.data(), length, nullptr, nullptr);
+                }
+                LocalFree(description);
+            }
+
+            uintptr_t startAddress = 0;
+            if (NtQueryInformationThread_fn && NtQueryInformationThread_fn(thread, ThreadQuerySetWin32StartAddress, &startAddress, sizeof(startAddress), nullptr) >= 0) {
+                HMODULE module = nullptr;
+                if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, reinterpret_cast<LPCWSTR>(startAddress), &module)) {
+                    char path[MAX_PATH] = {};
+                    GetModuleFileNameA(module, path, MAX_PATH);
+                    info.module = std::string(path).substr(std::string(path).find_last_of("\\/") + 1);
+                    std::transform(info.module.begin(), info.module.end(), info.module.begin(), [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c; });
+                    info.inThisModule = (module == thisModule);
+                }
+                info.atEntryPoint = (startAddress == entryPoint);
+            }
+
+            CloseHandle(thread);
+            threads.push_back(std::move(info));
+        }
+        CloseHandle(snapshot);
+        return threads;
+    }
+
+    // Sets the thread's affinity (if mask is non-zero) and moves its priority by priorityOffset steps, staying between lowest and highest.
+    inline bool Apply(uint32_t threadId, uint64_t mask, int priorityOffset)
+    {
+        HANDLE thread = OpenThread(THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION, FALSE, threadId);
+        if (!thread)
+            return false;
+
+        bool bResult = true;
+        if (mask)
+            bResult &= SetThreadAffinityMask(thread, static_cast<DWORD_PTR>(mask)) != 0;
+        if (priorityOffset) {
+            // Threads the game already runs outside the normal range (e.g. time critical) are left as they are.
+            int priority = GetThreadPriority(thread);
+            if (priority >= THREAD_PRIORITY_LOWEST && priority <= THREAD_PRIORITY_HIGHEST)
+                bResult &= SetThreadPriority(thread, std::clamp(priority + priorityOffset, THREAD_PRIORITY_LOWEST, THREAD_PRIORITY_HIGHEST)) != 0;
+        }
+        CloseHandle(thread);
+        return bResult;
+    }
+#endif
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <array>
+#include <atomic>
+
+// Startup timeline.
+// Scoped spans are recorded into a fixed array and written out as Chrome trace-event JSON, which Perfetto and chrome://tracing open.
+// Recording a span is two QueryPerformanceCounter calls and one atomic increment, so it stays cheap enough for release builds.
+namespace Timeline
+{
+    inline constexpr size_t Capacity = 1024;
+
+    struct Event
+    {
+        const char* name;
+        const char* category;
+        const char* detail;     // Optional, must outlive the timeline (e.g. a string literal)
+        int64_t begin;
+        int64_t end;
+        std::atomic<uint32_t> threadId;  // Written last, 0 until the event is complete
+    };
+
+    inline std::array<Event, Capacity> events{};
+    inline std::atomic<size_t> count{ 0 };
+    // Spans are recorded from startup until the config says otherwise, so Logging and Configuration are covered.
+    inline std::atomic<bool> bEnabled{ true };
+    inline int64_t origin = []() { LARGE_INTEGER now; QueryPerformanceCounter(&now); return now.QuadPart; }();
+
+    inline int64_t Now()
+    {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return now.QuadPart;
+    }
+
+    class Span
+    {
+    public:
+        Span(const char* name, const char* category, const char* detail = nullptr)
+            : m_name(name), m_category(category), m_detail(detail)
+        {
+            if (bEnabled.load(std::memory_order_relaxed))
+                m_begin = Now();
+        }
+
+        ~Span()
+        {
+            if (!m_begin)
+                return;
+
+            const int64_t end = Now();
+            const size_t index = count.fetch_add(1, std::memory_order_relaxed);
+            if (index >= Capacity)
+                return;
+
+            Event& event = events[index];
+            event.name = m_name;
+            event.category = m_category;
+            event.detail = m_detail;
+            event.begin = m_begin;
+            event.end = end;
+            event.threadId.store(GetCurrentThreadId(), std::memory_order_release);
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* m_name;
+        const char* m_category;
+        const char* m_detail;
+        int64_t m_begin = 0;
+    };
+
+    template<typename Fn>
+    void Run(const char* name, Fn&& fn)
+    {
+        Span span(name, "startup");
+        fn();
+    }
+
+    inline void AppendEscaped(std::string& out, const char* text)
+    {
+        for (; *text; ++text) {
+            if (*text == '"' || *text == '\\')
+                out += '\\';
+            if (static_cast<unsigned char>(*text) >= 0x20)
+                out += *text;
+        }
+    }
+
+    // Writes every recorded span. Spans still open on other threads are left out.
+    inline bool Write(const std::filesystem::path& path)
+    {
+        LARGE_INTEGER frequency{};
+        QueryPerformanceFrequency(&frequency);
+        const double toMicroseconds = 1000000.0 / static_cast<double>(frequency.QuadPart);
+
+        const size_t total = std::min(count.load(std::memory_order_relaxed), Capacity);
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        char buffer[160];
+        bool bFirst = true;
+        for (size_t i = 0; i < total; ++i) {
+            const Event& event = events[i];
+            const uint32_t threadId = event.threadId.load(std::memory_order_acquire);
+            if (!threadId)
+                continue;
+
+            json += bFirst ? "\n" : ",\n";
+            bFirst = false;
+            snprintf(buffer, sizeof(buffer), "{\"ph\":\"X\",\"pid\":%lu,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":\"",
+                GetCurrentProcessId(), threadId, (event.begin - origin) * toMicroseconds, (event.end - event.begin) * toMicroseconds);
+            json += buffer;
+            AppendEscaped(json, event.name);
+            json += "\",\"cat\":\"";
+            AppendEscaped(json, event.category);
+            json += "\"";
+            if (event.detail) {
+                json += ",\"args\":{\"detail\":\"";
+                AppendEscaped(json, event.detail);
+                json += "\"}";
+            }
+            json += "}";
+        }
+        json += "\n]}\n";
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        file.write(json.data(), json.size());
+        return static_cast<bool>(file);
+    }
+}
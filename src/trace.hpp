@@ -0,0 +1,135 @@
+#pragma once
+
+// Binary trace log.
+// Fixed-size records are written into a memory-mapped circular file, so nothing is formatted on the hot path
+// and the trace survives a crash. The layout below is shared with tools/trace_decoder.cpp and must stay portable.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <filesystem>
+#endif
+
+namespace Trace
+{
+    inline constexpr char Magic[8] = { 'M', 'F', 'T', 'R', 'A', 'C', 'E', '\0' };
+    inline constexpr uint32_t Version = 1;
+
+    enum class Event : uint16_t
+    {
+        None = 0,
+        ResolutionChanged = 1,  // payload: width, height
+        TitleStateChanged = 2,  // payload: previous state, new state
+        HookHit = 3,            // payload: Hook id, hit count
+        FrameLatency = 4        // payload: sim to present microseconds, present to GPU done microseconds
+    };
+
+    enum class Hook : uint16_t
+    {
+        ResolutionScale = 0,
+        AOResolution = 1,
+        ResolutionFix = 2,
+        IntroSkip = 3
+    };
+    inline constexpr size_t HookCount = 4;
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t capacity;          // Number of records in the ring
+        uint64_t timerFrequency;    // QueryPerformanceFrequency
+        uint64_t writeIndex;        // Total records ever written, updated atomically
+        uint8_t reserved[24];
+    };
+    static_assert(sizeof(FileHeader) == 64);
+
+    struct Record
+    {
+        uint64_t timestamp;         // QueryPerformanceCounter
+        uint64_t sequence;          // Index + 1, written last. A mismatch means the record was torn or never written.
+        uint16_t event;
+        uint16_t reserved[3];
+        uint64_t payload[2];
+    };
+    static_assert(sizeof(Record) == 40);
+
+#ifdef _WIN32
+    inline FileHeader* header = nullptr;
+    inline Record* records = nullptr;
+
+    // Maps (and truncates) the trace file. Returns false if tracing couldn't be started.
+    inline bool Open(const std::filesystem::path& path, uint64_t capacity)
+    {
+        const uint64_t fileSize = sizeof(FileHeader) + capacity * sizeof(Record);
+
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(fileSize >> 32), static_cast<DWORD>(fileSize), nullptr);
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, fileSize);
+        CloseHandle(mapping);
+        if (!view)
+            return false;
+
+        LARGE_INTEGER frequency{};
+        QueryPerformanceFrequency(&frequency);
+
+        auto* mappedHeader = static_cast<FileHeader*>(view);
+        memcpy(mappedHeader->magic, Magic, sizeof(Magic));
+        mappedHeader->version = Version;
+        mappedHeader->recordSize = sizeof(Record);
+        mappedHeader->capacity = capacity;
+        mappedHeader->timerFrequency = static_cast<uint64_t>(frequency.QuadPart);
+        mappedHeader->writeIndex = 0;
+
+        records = reinterpret_cast<Record*>(mappedHeader + 1);
+        std::atomic_thread_fence(std::memory_order_release);
+        header = mappedHeader;
+        return true;
+    }
+
+    inline void Write(Event event, uint64_t a = 0, uint64_t b = 0)
+    {
+        if (!header)
+            return;
+
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+
+        const uint64_t index = std::atomic_ref<uint64_t>(header->writeIndex).fetch_add(1, std::memory_order_relaxed);
+        Record& record = records[index % header->capacity];
+        std::atomic_ref<uint64_t>(record.sequence).store(0, std::memory_order_relaxed);
+        record.timestamp = static_cast<uint64_t>(now.QuadPart);
+        record.event = static_cast<uint16_t>(event);
+        record.payload[0] = a;
+        record.payload[1] = b;
+        std::atomic_ref<uint64_t>(record.sequence).store(index + 1, std::memory_order_release);
+    }
+
+    // Also published as telemetry, so hits are counted if either is on. Set before any hooks are installed.
+    inline bool bCountHits = false;
+    inline std::atomic<uint64_t> hits[HookCount]{};
+
+    inline void HookHit(Hook hook)
+    {
+        if (!bCountHits)
+            return;
+
+        const auto id = static_cast<uint16_t>(hook);
+        const uint64_t count = hits[id].fetch_add(1, std::memory_order_relaxed) + 1;
+        if (header)
+            Write(Event::HookHit, id, count);
+    }
+#endif
+}
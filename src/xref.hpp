@@ -0,0 +1,247 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <Zydis.h>
+
+#include <algorithm>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Cross-reference index over the game's code section.
+// Maps every RIP-relative data reference and every call/jmp rel32 target to the instructions that reference it.
+// Relies on Memory:: from helper.hpp, so include it after that.
+namespace XRef
+{
+    enum class Kind : uint8_t
+    {
+        Data,   // RIP-relative memory operand
+        Call,   // call rel32
+        Jump    // jmp rel32
+    };
+
+    // All addresses are stored as RVAs to keep the index small and cacheable.
+    struct Reference
+    {
+        uint32_t source;
+        uint32_t target;
+        Kind kind;
+    };
+
+    class Index
+    {
+    public:
+        // Builds the index from the module's .text section, or loads it from cachePath if it was built for the same module timestamp.
+        bool Build(void* module, const std::filesystem::path& cachePath)
+        {
+            m_module = reinterpret_cast<std::uint8_t*>(module);
+            const uint32_t timestamp = Memory::ModuleTimestamp(module);
+            auto ntHeaders = (PIMAGE_NT_HEADERS)(m_module + ((PIMAGE_DOS_HEADER)m_module)->e_lfanew);
+
+            if (!Load(cachePath, timestamp, ntHeaders->OptionalHeader.SizeOfImage)) {
+                auto [textStart, textSize] = Memory::GetSection(module, ".text");
+                if (!textStart)
+                    return false;
+
+                Scan(textStart, textSize);
+                Save(cachePath, timestamp);
+            }
+
+            BuildLookup();
+            return true;
+        }
+
+        // Every instruction that references target. O(1) lookup.
+        std::span<const Reference> To(uintptr_t target) const
+        {
+            if (m_lookup.empty() || target < (uintptr_t)m_module)
+                return {};
+
+            const auto rva = static_cast<uint32_t>(target - (uintptr_t)m_module);
+            const size_t mask = m_lookup.size() - 1;
+            for (size_t i = Hash(rva) & mask; m_lookup[i].count != 0; i = (i + 1) & mask) {
+                if (m_lookup[i].target == rva)
+                    return { m_refs.data() + m_lookup[i].begin, m_lookup[i].count };
+            }
+            return {};
+        }
+
+        // Addresses of instructions of the given kind that reference target.
+        std::vector<uintptr_t> Sources(uintptr_t target, Kind kind) const
+        {
+            std::vector<uintptr_t> sources{};
+            for (const auto& ref : To(target)) {
+                if (ref.kind == kind)
+                    sources.push_back((uintptr_t)m_module + ref.source);
+            }
+            return sources;
+        }
+
+        size_t Size() const { return m_refs.size(); }
+        size_t Bytes() const { return m_refs.size() * sizeof(Reference) + m_lookup.size() * sizeof(Slot); }
+        bool Loaded() const { return m_loadedFromCache; }
+
+    private:
+        struct Slot
+        {
+            uint32_t target;
+            uint32_t begin;
+            uint32_t count;
+        };
+
+        static constexpr uint32_t CacheMagic = 0x5246584D; // "MXFR"
+        static constexpr uint32_t CacheVersion = 1;
+
+        std::uint8_t* m_module{};
+        std::vector<Reference> m_refs{};    // Sorted by target
+        std::vector<Slot> m_lookup{};       // Open-addressed table of target -> range in m_refs
+        bool m_loadedFromCache = false;
+
+        static size_t Hash(uint32_t rva) { return (rva * 0x9E3779B1u) >> 4; }
+
+        void Scan(std::uint8_t* textStart, size_t textSize)
+        {
+            const uintptr_t imageStart = (uintptr_t)m_module;
+            auto ntHeaders = (PIMAGE_NT_HEADERS)(m_module + ((PIMAGE_DOS_HEADER)m_module)->e_lfanew);
+            const uintptr_t imageEnd = imageStart + ntHeaders->OptionalHeader.SizeOfImage;
+
+            // Linear sweep in parallel chunks. The decoder resynchronises within a few instructions of a chunk boundary.
+            const size_t threadCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 16);
+            const size_t chunkSize = (textSize + threadCount - 1) / threadCount;
+            std::vector<std::vector<Reference>> results(threadCount);
+            std::vector<std::thread> threads{};
+
+            for (size_t t = 0; t < threadCount; ++t) {
+                threads.emplace_back([&, t]() {
+                    ZydisDecoder decoder{};
+                    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+                    ZydisDecoderEnableMode(&decoder, ZYDIS_DECODER_MODE_MINIMAL, ZYAN_TRUE);
+
+                    const size_t begin = t * chunkSize;
+                    const size_t end = std::min(textSize, begin + chunkSize);
+                    auto& out = results[t];
+                    out.reserve((end - begin) / 16);
+
+                    ZydisDecodedInstruction ix{};
+                    for (size_t offset = begin; offset < end;) {
+                        std::uint8_t* ip = textStart + offset;
+                        if (!ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(&decoder, nullptr, ip, textSize - offset, &ix))) {
+                            ++offset;
+                            continue;
+                        }
+
+                        const uintptr_t next = (uintptr_t)ip + ix.length;
+                        uintptr_t target = 0;
+                        Kind kind = Kind::Data;
+
+                        if ((ix.attributes & ZYDIS_ATTRIB_HAS_MODRM) && ix.raw.modrm.mod == 0 && ix.raw.modrm.rm == 5 && ix.raw.disp.size == 32) {
+                            target = next + ix.raw.disp.value;
+                        }
+                        else if ((ix.mnemonic == ZYDIS_MNEMONIC_CALL || ix.mnemonic == ZYDIS_MNEMONIC_JMP) && ix.raw.imm[0].is_relative && ix.raw.imm[0].size == 32) {
+                            target = next + ix.raw.imm[0].value.s;
+                            kind = (ix.mnemonic == ZYDIS_MNEMONIC_CALL) ? Kind::Call : Kind::Jump;
+                        }
+
+                        // Anything pointing outside the image is a misdecode.
+                        if (target >= imageStart && target < imageEnd)
+                            out.push_back({ static_cast<uint32_t>((uintptr_t)ip - imageStart), static_cast<uint32_t>(target - imageStart), kind });
+
+                        offset += ix.length;
+                    }
+                    });
+            }
+            for (auto& thread : threads)
+                thread.join();
+
+            size_t total = 0;
+            for (const auto& result : results)
+                total += result.size();
+
+            m_refs.clear();
+            m_refs.reserve(total);
+            for (const auto& result : results)
+                m_refs.insert(m_refs.end(), result.begin(), result.end());
+
+            std::sort(m_refs.begin(), m_refs.end(), [](const Reference& a, const Reference& b) {
+                return a.target != b.target ? a.target < b.target : a.source < b.source;
+                });
+            m_refs.erase(std::unique(m_refs.begin(), m_refs.end(), [](const Reference& a, const Reference& b) {
+                return a.source == b.source && a.target == b.target;
+                }), m_refs.end());
+        }
+
+        void BuildLookup()
+        {
+            size_t uniqueTargets = 0;
+            for (size_t i = 0; i < m_refs.size(); ++i) {
+                if (i == 0 || m_refs[i].target != m_refs[i - 1].target)
+                    ++uniqueTargets;
+            }
+
+            size_t capacity = 16;
+            while (capacity < uniqueTargets * 2)
+                capacity <<= 1;
+
+            m_lookup.assign(capacity, Slot{});
+            const size_t mask = capacity - 1;
+            for (size_t i = 0; i < m_refs.size();) {
+                size_t j = i;
+                while (j < m_refs.size() && m_refs[j].target == m_refs[i].target)
+                    ++j;
+
+                size_t slot = Hash(m_refs[i].target) & mask;
+                while (m_lookup[slot].count != 0)
+                    slot = (slot + 1) & mask;
+                m_lookup[slot] = { m_refs[i].target, static_cast<uint32_t>(i), static_cast<uint32_t>(j - i) };
+                i = j;
+            }
+        }
+
+        // Rejects a cache whose count doesn't match the file size, or whose references aren't sorted, typed and inside the image,
+        // so a truncated or corrupt file is rebuilt instead of trusted.
+        bool Load(const std::filesystem::path& cachePath, uint32_t timestamp, uint32_t sizeOfImage)
+        {
+            std::ifstream file(cachePath, std::ios::binary | std::ios::ate);
+            if (!file)
+                return false;
+            const auto fileSize = static_cast<uint64_t>(file.tellg());
+            file.seekg(0);
+
+            uint32_t header[4]{};
+            if (!file.read(reinterpret_cast<char*>(header), sizeof(header)))
+                return false;
+            if (header[0] != CacheMagic || header[1] != CacheVersion || header[2] != timestamp)
+                return false;
+            if (fileSize != sizeof(header) + static_cast<uint64_t>(header[3]) * sizeof(Reference))
+                return false;
+
+            m_refs.resize(header[3]);
+            if (!file.read(reinterpret_cast<char*>(m_refs.data()), m_refs.size() * sizeof(Reference))) {
+                m_refs.clear();
+                return false;
+            }
+            for (size_t i = 0; i < m_refs.size(); ++i) {
+                const Reference& ref = m_refs[i];
+                if (ref.source >= sizeOfImage || ref.target >= sizeOfImage || ref.kind > Kind::Jump || (i && ref.target < m_refs[i - 1].target)) {
+                    m_refs.clear();
+                    return false;
+                }
+            }
+
+            m_loadedFromCache = true;
+            return true;
+        }
+
+        void Save(const std::filesystem::path& cachePath, uint32_t timestamp) const
+        {
+            std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+            if (!file)
+                return;
+
+            const uint32_t header[4] = { CacheMagic, CacheVersion, timestamp, static_cast<uint32_t>(m_refs.size()) };
+            file.write(reinterpret_cast<const char*>(header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(m_refs.data()), m_refs.size() * sizeof(Reference));
+        }
+    };
+}
@@ -0,0 +1,165 @@
+// Replays a MetaphorFix callback capture (MetaphorFix.capture) through src/callbacks.hpp.
+// Checks each callback still produces the recorded output and reports the average cost per call.
+// GlobalFOV goes through tan/atan, so a capture from the game can differ by an ulp from a Linux libm.
+// GlobalFOV is memoised (src/memo.hpp), so after the first iteration its timing is the cache-hit path, as in game.
+//   g++ -std=c++23 -O2 -o callback_replay tools/callback_replay.cpp
+//   callback_replay MetaphorFix.capture [iterations]
+
+#include "../src/capture.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Region
+{
+    Capture::Region region;
+    std::vector<uint8_t> before;
+    std::vector<uint8_t> after;
+};
+
+struct Record
+{
+    Capture::RecordHeader header;
+    std::vector<Region> regions;
+};
+
+struct Stats
+{
+    const char* name;
+    size_t records = 0;
+    size_t skipped = 0;
+    size_t mismatches = 0;
+    double nanoseconds = 0;
+};
+
+static void Run(Capture::Hook hook, Capture::Context& ctx, const Callbacks::State& state)
+{
+    switch (hook) {
+    case Capture::Hook::GlobalFOV: Callbacks::GlobalFOV(ctx, state); break;
+    case Capture::Hook::HUDOffset:
+    case Capture::Hook::HUDOffsetClip: Callbacks::HUDOffset(ctx, state); break;
+    case Capture::Hook::ElementSize: Callbacks::ElementSize(ctx, state); break;
+    case Capture::Hook::FadeWipe: Callbacks::FadeWipe(ctx, state); break;
+    }
+}
+
+// Copies the captured memory into buffers and points the registers at them, keeping the captured offsets.
+static void Prepare(const Record& record, Capture::Context& ctx, std::vector<std::vector<uint8_t>>& buffers)
+{
+    ctx = record.header.before;
+    for (size_t i = 0; i < record.regions.size(); ++i) {
+        const auto& region = record.regions[i];
+        // Extra zero byte so strings that ran past the captured region stay terminated
+        buffers[i].assign(region.before.begin(), region.before.end());
+        buffers[i].push_back(0);
+        Capture::Gpr(ctx, region.region.reg) = (uint64_t)(uintptr_t)buffers[i].data() - region.region.offset;
+    }
+}
+
+static bool Matches(const Record& record, const Capture::Context& ctx, const std::vector<std::vector<uint8_t>>& buffers)
+{
+    // Registers holding relocated pointers are compared against the buffer addresses instead.
+    Capture::Context expected = record.header.after;
+    for (size_t i = 0; i < record.regions.size(); ++i)
+        Capture::Gpr(expected, record.regions[i].region.reg) = Capture::Gpr(ctx, record.regions[i].region.reg);
+    if (memcmp(&expected, &ctx, sizeof(ctx)) != 0)
+        return false;
+
+    for (size_t i = 0; i < record.regions.size(); ++i) {
+        if (memcmp(buffers[i].data(), record.regions[i].after.data(), record.regions[i].after.size()) != 0)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <MetaphorFix.capture> [iterations]" << std::endl;
+        return 1;
+    }
+    const size_t iterations = (argc > 2) ? std::stoul(argv[2]) : 1000;
+
+    std::ifstream file(argv[1], std::ios::binary);
+    Capture::FileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::cerr << "Could not read capture header." << std::endl;
+        return 1;
+    }
+    if (memcmp(header.magic, Capture::Magic, sizeof(Capture::Magic)) != 0 || header.version != Capture::Version || header.contextSize != sizeof(Capture::Context)) {
+        std::cerr << "Not a supported capture file." << std::endl;
+        return 1;
+    }
+
+    std::vector<Record> records{};
+    for (;;) {
+        Record record{};
+        if (!file.read(reinterpret_cast<char*>(&record.header), sizeof(record.header)))
+            break;
+        for (uint8_t i = 0; i < record.header.regionCount; ++i) {
+            Capture::RegionHeader regionHeader{};
+            file.read(reinterpret_cast<char*>(&regionHeader), sizeof(regionHeader));
+            Region region{ regionHeader.region, std::vector<uint8_t>(regionHeader.region.size), std::vector<uint8_t>(regionHeader.region.size) };
+            file.read(reinterpret_cast<char*>(region.before.data()), region.before.size());
+            file.read(reinterpret_cast<char*>(region.after.data()), region.after.size());
+            record.regions.push_back(std::move(region));
+        }
+        if (!file) {
+            std::cerr << "Capture is truncated, ignoring the last record." << std::endl;
+            break;
+        }
+        records.push_back(std::move(record));
+    }
+
+    Stats stats[] = { { "GlobalFOV" }, { "HUDOffset" }, { "HUDOffsetClip" }, { "ElementSize" }, { "FadeWipe" } };
+    std::vector<std::vector<uint8_t>> buffers{};
+    Capture::Context ctx{};
+
+    for (const auto& record : records) {
+        if (record.header.hook >= std::size(stats))
+            continue;
+        auto& stat = stats[record.header.hook];
+        const auto hook = static_cast<Capture::Hook>(record.header.hook);
+        ++stat.records;
+        if (record.header.unreadable) {
+            ++stat.skipped;
+            continue;
+        }
+
+        buffers.resize(record.regions.size());
+        Prepare(record, ctx, buffers);
+        Run(hook, ctx, record.header.state);
+        if (!Matches(record, ctx, buffers))
+            ++stat.mismatches;
+
+        // Time setup plus callback, then setup alone, and report the difference.
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            Prepare(record, ctx, buffers);
+            Run(hook, ctx, record.header.state);
+        }
+        const auto middle = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+            Prepare(record, ctx, buffers);
+        const auto end = std::chrono::steady_clock::now();
+
+        const double total = std::chrono::duration<double, std::nano>(middle - start).count();
+        const double setup = std::chrono::duration<double, std::nano>(end - middle).count();
+        stat.nanoseconds += std::max(0.0, total - setup) / static_cast<double>(iterations);
+    }
+
+    bool bMismatch = false;
+    std::printf("%-14s %8s %8s %10s %12s\n", "Callback", "Records", "Skipped", "Mismatch", "ns/call");
+    for (const auto& stat : stats) {
+        const size_t replayed = stat.records - stat.skipped;
+        std::printf("%-14s %8zu %8zu %10zu %12.1f\n", stat.name, stat.records, stat.skipped, stat.mismatches, replayed ? stat.nanoseconds / static_cast<double>(replayed) : 0.0);
+        bMismatch |= stat.mismatches != 0;
+    }
+    return bMismatch ? 2 : 0;
+}
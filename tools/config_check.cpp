@@ -0,0 +1,307 @@
+// Fuzzes and times the schema-driven ini loader (src/config.hpp) against the fix's own schema (src/settings.hpp).
+//   g++ -std=c++20 -O2 -fsanitize=address,undefined -o config_check tools/config_check.cpp
+//   config_check fuzz MetaphorFix.ini [iterations] [seed]
+//   config_check bench MetaphorFix.ini [iterations]
+// fuzz first checks the shipped ini sets every setting in the schema. It then feeds mutated and random text through
+// Config::Load and checks every value ends up valid, in range and rounded to its multiple, and that well-formed values
+// written back into the file read back exactly.
+// bench times a full parse. If inipp is on the include path (-I path/to/inipp), the old inipp::Ini parse plus a
+// get_value per setting is timed alongside it.
+
+#include "../src/config.hpp"
+#include "../src/settings.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if __has_include(<inipp/inipp.h>)
+#include <inipp/inipp.h>
+#define HAVE_INIPP 1
+#endif
+
+static double Read(const Config::Setting& setting)
+{
+    switch (setting.type) {
+    case Config::Type::Bool: return *static_cast<const bool*>(setting.value);
+    case Config::Type::Int: return *static_cast<const int*>(setting.value);
+    case Config::Type::Float: return *static_cast<const float*>(setting.value);
+    case Config::Type::AtomicFloat: return static_cast<const std::atomic<float>*>(setting.value)->load();
+    }
+    return 0;
+}
+
+static std::string ReadFile(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+// Every value must be a real value of its type and inside its range, whatever the input was.
+static bool CheckValues(std::span<const Config::Setting> settings, const std::vector<Config::Status>& statuses, std::string& error)
+{
+    if (statuses.size() != settings.size()) {
+        error = "status count differs from schema size";
+        return false;
+    }
+    for (size_t i = 0; i < settings.size(); ++i) {
+        const Config::Setting& setting = settings[i];
+        const double value = Read(setting);
+        if (setting.type == Config::Type::Bool) {
+            const auto raw = *static_cast<const uint8_t*>(setting.value);
+            if (raw > 1) {
+                error = std::string(setting.key) + " holds a bool that is neither 0 nor 1";
+                return false;
+            }
+            continue;
+        }
+        if (!std::isfinite(value) && setting.min <= setting.max) {
+            error = std::string(setting.key) + " is not finite";
+            return false;
+        }
+        if (setting.min <= setting.max && (value < setting.min || value > setting.max)) {
+            error = std::string(setting.key) + " = " + std::to_string(value) + " is outside [" + std::to_string(setting.min) + ", " + std::to_string(setting.max) + "]";
+            return false;
+        }
+        if (setting.multiple > 0 && static_cast<int>(value) % setting.multiple != 0) {
+            error = std::string(setting.key) + " = " + std::to_string(value) + " is not a multiple of " + std::to_string(setting.multiple);
+            return false;
+        }
+    }
+    return true;
+}
+
+// The shipped ini should set every setting, with a value the schema accepts as is: not clamped, and not rounded to a
+// multiple, which Load doesn't report, so the value is read back from the file's text too.
+static size_t CheckShipped(const std::string& ini)
+{
+    size_t failures = 0;
+    const auto statuses = Config::Load(ini, ConfigSchema);
+    for (size_t i = 0; i < std::size(ConfigSchema); ++i) {
+        const Config::Setting& setting = ConfigSchema[i];
+        if (statuses[i] != Config::Status::Parsed) {
+            std::cerr << "Shipped ini: " << setting.section << "/" << setting.key << " has status " << static_cast<int>(statuses[i]) << "\n";
+            ++failures;
+            continue;
+        }
+        if (setting.type == Config::Type::Int && setting.multiple > 0) {
+            const std::string written = std::string(setting.key) + " = " + std::to_string(static_cast<int>(Read(setting)));
+            const size_t section = ini.find(std::string("[") + setting.section + "]");
+            if (section == std::string::npos || ini.find(written, section) != ini.find(std::string(setting.key) + " =", section)) {
+                std::cerr << "Shipped ini: " << setting.section << "/" << setting.key << " isn't a multiple of " << setting.multiple << "\n";
+                ++failures;
+            }
+        }
+    }
+    return failures;
+}
+
+static std::string Mutate(std::string text, std::mt19937_64& rng)
+{
+    static const char* Fragments[] = {
+        "\n", "\r\n", "[", "]", "=", ";", "#", " ", "\t", "\xEF\xBB\xBF", "nan", "-nan", "inf", "-inf", "1e39", "-1e39",
+        "2147483647", "-2147483648", "99999999999999999999", "0x10", "TRUE", "False", "1.", ".5", "+1", "--1", "1e", "=", "[Fix HUD",
+        "Enabled", "Resolution", "Multiplier",
+    };
+    auto pick = [&](size_t size) { return static_cast<size_t>(rng() % (size + 1)); };
+
+    const int edits = 1 + static_cast<int>(rng() % 8);
+    for (int e = 0; e < edits; ++e) {
+        switch (rng() % 7) {
+        case 0: // Flip a byte
+            if (!text.empty())
+                text[pick(text.size() - 1)] ^= static_cast<char>(1 << (rng() % 8));
+            break;
+        case 1: // Random byte, including NUL
+            text.insert(text.begin() + pick(text.size()), static_cast<char>(rng()));
+            break;
+        case 2: // Fragment
+            text.insert(pick(text.size()), Fragments[rng() % std::size(Fragments)]);
+            break;
+        case 3: // Truncate
+            text.resize(pick(text.size()));
+            break;
+        case 4: { // Duplicate a slice
+            const size_t begin = pick(text.size());
+            const size_t size = std::min<size_t>(text.size() - begin, rng() % 256);
+            text.insert(pick(text.size()), text.substr(begin, size));
+            break;
+        }
+        case 5: { // Delete a slice
+            const size_t begin = pick(text.size());
+            text.erase(begin, std::min<size_t>(text.size() - begin, rng() % 64));
+            break;
+        }
+        case 6: { // Replace a value with a fragment
+            const size_t equals = text.find('=', pick(text.size()));
+            if (equals != std::string::npos) {
+                const size_t lineEnd = text.find('\n', equals);
+                text.replace(equals + 1, (lineEnd == std::string::npos ? text.size() : lineEnd) - equals - 1, Fragments[rng() % std::size(Fragments)]);
+            }
+            break;
+        }
+        }
+    }
+    return text;
+}
+
+static int Fuzz(const std::string& ini, size_t iterations, uint64_t seed)
+{
+    const std::span<const Config::Setting> schema = ConfigSchema;
+    std::mt19937_64 rng(seed);
+
+    size_t failures = CheckShipped(ini);
+    std::string error{};
+    for (size_t i = 0; i < iterations; ++i) {
+        // Mostly mutations of the real file, sometimes pure noise.
+        std::string text{};
+        if (i % 16 == 15) {
+            text.resize(rng() % 4096);
+            for (auto& c : text)
+                c = static_cast<char>(rng());
+        }
+        else {
+            text = Mutate(ini, rng);
+        }
+
+        if (!CheckValues(schema, Config::Load(text, schema), error)) {
+            if (++failures <= 5) {
+                std::ofstream(std::string("config_check.fail") + std::to_string(failures) + ".ini", std::ios::binary) << text;
+                std::cerr << "Iteration " << i << ": " << error << " (input saved to config_check.fail" << failures << ".ini)\n";
+            }
+        }
+
+        // Round trip: write a valid value for every setting and check it reads back exactly.
+        std::ostringstream written{};
+        std::vector<double> expected(schema.size());
+        const char* section = nullptr;
+        for (size_t s = 0; s < schema.size(); ++s) {
+            const Config::Setting& setting = schema[s];
+            if (!section || std::string_view(section) != setting.section)
+                written << "\n[" << (section = setting.section) << "]\n";
+            const double low = setting.min <= setting.max ? setting.min : -1000.0;
+            const double high = setting.min <= setting.max ? setting.max : 1000.0;
+            written << setting.key << " = ";
+            switch (setting.type) {
+            case Config::Type::Bool:
+                expected[s] = static_cast<double>(rng() % 2);
+                written << (expected[s] ? (rng() % 2 ? "true" : "TRUE") : (rng() % 2 ? "false" : "0"));
+                break;
+            case Config::Type::Int: {
+                const int step = std::max(1, setting.multiple);
+                const int value = static_cast<int>(std::ceil(low / step)) * step;
+                const int count = static_cast<int>(std::floor(high / step)) - static_cast<int>(std::ceil(low / step)) + 1;
+                expected[s] = value + static_cast<int>(rng() % std::max(1, count)) * step;
+                written << static_cast<int>(expected[s]);
+                break;
+            }
+            case Config::Type::Float:
+            case Config::Type::AtomicFloat: {
+                // Written with enough digits to read back as the same float, then kept in range after rounding to float.
+                float value = static_cast<float>(low + (high - low) * static_cast<double>(rng() % 1001) / 1000.0);
+                while (value < low)
+                    value = std::nextafter(value, INFINITY);
+                while (value > high)
+                    value = std::nextafter(value, -INFINITY);
+                char buffer[32];
+                snprintf(buffer, sizeof(buffer), "%.9g", value);
+                written << buffer;
+                expected[s] = value;
+                break;
+            }
+            }
+            written << (rng() % 2 ? " ; comment\n" : "\r\n");
+        }
+        const auto statuses = Config::Load(written.str(), schema);
+        for (size_t s = 0; s < schema.size(); ++s) {
+            if (statuses[s] != Config::Status::Parsed || Read(schema[s]) != expected[s]) {
+                if (++failures <= 5)
+                    std::cerr << "Iteration " << i << ": " << schema[s].section << "/" << schema[s].key << " didn't round trip ("
+                    << Read(schema[s]) << " instead of " << expected[s] << ", status " << static_cast<int>(statuses[s]) << ")\n";
+                break;
+            }
+        }
+    }
+
+    printf("%zu settings, %zu iterations, seed %llu: %zu failure(s).\n", schema.size(), iterations, (unsigned long long)seed, failures);
+    return failures ? 1 : 0;
+}
+
+static int Bench(const std::string& ini, size_t iterations)
+{
+    const std::span<const Config::Setting> schema = ConfigSchema;
+
+    auto time = [&](auto&& parse) {
+        double best = 1e30;
+        for (int run = 0; run < 5; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+                parse();
+            best = std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(iterations));
+        }
+        return best;
+        };
+
+    size_t parsed = 0;
+    const double schemaTime = time([&] {
+        const auto statuses = Config::Load(ini, schema);
+        parsed += std::count(statuses.begin(), statuses.end(), Config::Status::Parsed);
+        });
+    printf("%zu settings, %zu bytes, best of 5 runs of %zu parses.\n", schema.size(), ini.size(), iterations);
+    printf("Config::Load         %8.2fus per parse\n", schemaTime);
+
+#ifdef HAVE_INIPP
+    // What the fix did before: parse the whole file into maps, then look every setting up.
+    const double inippTime = time([&] {
+        inipp::Ini<char> iniFile;
+        std::istringstream stream(ini);
+        iniFile.parse(stream);
+        iniFile.strip_trailing_comments();
+        for (const auto& setting : schema) {
+            auto& section = iniFile.sections[setting.section];
+            switch (setting.type) {
+            case Config::Type::Bool: inipp::get_value(section, setting.key, *static_cast<bool*>(setting.value)); break;
+            case Config::Type::Int: inipp::get_value(section, setting.key, *static_cast<int*>(setting.value)); break;
+            case Config::Type::Float: inipp::get_value(section, setting.key, *static_cast<float*>(setting.value)); break;
+            case Config::Type::AtomicFloat: break;
+            }
+        }
+        });
+    printf("inipp                %8.2fus per parse (%.1fx)\n", inippTime, inippTime / schemaTime);
+#else
+    printf("inipp                not on the include path, skipped\n");
+#endif
+    return parsed ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " fuzz <MetaphorFix.ini> [iterations] [seed]\n"
+            << "       " << argv[0] << " bench <MetaphorFix.ini> [iterations]" << std::endl;
+        return 1;
+    }
+    const std::string mode = argv[1];
+    const std::string ini = ReadFile(argv[2]);
+    if (ini.empty()) {
+        std::cerr << "Could not read " << argv[2] << std::endl;
+        return 1;
+    }
+
+    if (mode == "fuzz")
+        return Fuzz(ini, (argc > 3) ? std::stoull(argv[3]) : 100000, (argc > 4) ? std::stoull(argv[4]) : 1);
+    if (mode == "bench")
+        return Bench(ini, (argc > 3) ? std::stoull(argv[3]) : 10000);
+
+    std::cerr << "Unknown mode " << mode << std::endl;
+    return 1;
+}
@@ -0,0 +1,186 @@
+// Times a call through a RegisterLoadHook stub (src/stub.hpp) against a call through SafetyHook's mid hook stub doing the
+// same register load, for the hooks that were converted.
+// Each hook gets a stand-in site that jumps to its stub, and a trampoline that is a plain ret, so calling the site returns
+// the register the hook loaded. The mid hook uses SafetyHook's x64 Windows stub byte for byte, with an ms_abi destination
+// so it also runs on Linux.
+//   g++ -std=c++23 -O2 -o hook_bench tools/hook_bench.cpp
+//   hook_bench [calls]
+
+#include "../external/safetyhook/safetyhook.hpp"
+#include "../src/stub.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#define HOOK_ABI
+#else
+#include <sys/mman.h>
+#define HOOK_ABI __attribute__((ms_abi))
+#endif
+
+// SafetyHook's mid hook stub (external/safetyhook/safetyhook.cpp, x64 Windows). The destination goes in the 8 bytes at
+// size - 16 and the trampoline in the last 8.
+static constexpr std::array<uint8_t, 391> MidHookStub = { 0xFF, 0x35, 0x79, 0x01, 0x00, 0x00, 0x54, 0x54, 0x55, 0x50, 0x53, 0x51,
+    0x52, 0x56, 0x57, 0x41, 0x50, 0x41, 0x51, 0x41, 0x52, 0x41, 0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57,
+    0x9C, 0x48, 0x81, 0xEC, 0x00, 0x01, 0x00, 0x00, 0xF3, 0x44, 0x0F, 0x7F, 0xBC, 0x24, 0xF0, 0x00, 0x00, 0x00, 0xF3,
+    0x44, 0x0F, 0x7F, 0xB4, 0x24, 0xE0, 0x00, 0x00, 0x00, 0xF3, 0x44, 0x0F, 0x7F, 0xAC, 0x24, 0xD0, 0x00, 0x00, 0x00,
+    0xF3, 0x44, 0x0F, 0x7F, 0xA4, 0x24, 0xC0, 0x00, 0x00, 0x00, 0xF3, 0x44, 0x0F, 0x7F, 0x9C, 0x24, 0xB0, 0x00, 0x00,
+    0x00, 0xF3, 0x44, 0x0F, 0x7F, 0x94, 0x24, 0xA0, 0x00, 0x00, 0x00, 0xF3, 0x44, 0x0F, 0x7F, 0x8C, 0x24, 0x90, 0x00,
+    0x00, 0x00, 0xF3, 0x44, 0x0F, 0x7F, 0x84, 0x24, 0x80, 0x00, 0x00, 0x00, 0xF3, 0x0F, 0x7F, 0x7C, 0x24, 0x70, 0xF3,
+    0x0F, 0x7F, 0x74, 0x24, 0x60, 0xF3, 0x0F, 0x7F, 0x6C, 0x24, 0x50, 0xF3, 0x0F, 0x7F, 0x64, 0x24, 0x40, 0xF3, 0x0F,
+    0x7F, 0x5C, 0x24, 0x30, 0xF3, 0x0F, 0x7F, 0x54, 0x24, 0x20, 0xF3, 0x0F, 0x7F, 0x4C, 0x24, 0x10, 0xF3, 0x0F, 0x7F,
+    0x04, 0x24, 0x48, 0x8B, 0x8C, 0x24, 0x80, 0x01, 0x00, 0x00, 0x48, 0x83, 0xC1, 0x10, 0x48, 0x89, 0x8C, 0x24, 0x80,
+    0x01, 0x00, 0x00, 0x48, 0x8D, 0x0C, 0x24, 0x48, 0x89, 0xE3, 0x48, 0x83, 0xEC, 0x30, 0x48, 0x83, 0xE4, 0xF0, 0xFF,
+    0x15, 0xA8, 0x00, 0x00, 0x00, 0x48, 0x89, 0xDC, 0xF3, 0x0F, 0x6F, 0x04, 0x24, 0xF3, 0x0F, 0x6F, 0x4C, 0x24, 0x10,
+    0xF3, 0x0F, 0x6F, 0x54, 0x24, 0x20, 0xF3, 0x0F, 0x6F, 0x5C, 0x24, 0x30, 0xF3, 0x0F, 0x6F, 0x64, 0x24, 0x40, 0xF3,
+    0x0F, 0x6F, 0x6C, 0x24, 0x50, 0xF3, 0x0F, 0x6F, 0x74, 0x24, 0x60, 0xF3, 0x0F, 0x6F, 0x7C, 0x24, 0x70, 0xF3, 0x44,
+    0x0F, 0x6F, 0x84, 0x24, 0x80, 0x00, 0x00, 0x00, 0xF3, 0x44, 0x0F, 0x6F, 0x8C, 0x24, 0x90, 0x00, 0x00, 0x00, 0xF3,
+    0x44, 0x0F, 0x6F, 0x94, 0x24, 0xA0, 0x00, 0x00, 0x00, 0xF3, 0x44, 0x0F, 0x6F, 0x9C, 0x24, 0xB0, 0x00, 0x00, 0x00,
+    0xF3, 0x44, 0x0F, 0x6F, 0xA4, 0x24, 0xC0, 0x00, 0x00, 0x00, 0xF3, 0x44, 0x0F, 0x6F, 0xAC, 0x24, 0xD0, 0x00, 0x00,
+    0x00, 0xF3, 0x44, 0x0F, 0x6F, 0xB4, 0x24, 0xE0, 0x00, 0x00, 0x00, 0xF3, 0x44, 0x0F, 0x6F, 0xBC, 0x24, 0xF0, 0x00,
+    0x00, 0x00, 0x48, 0x81, 0xC4, 0x00, 0x01, 0x00, 0x00, 0x9D, 0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x41,
+    0x5B, 0x41, 0x5A, 0x41, 0x59, 0x41, 0x58, 0x5F, 0x5E, 0x5A, 0x59, 0x5B, 0x58, 0x5D, 0x48, 0x8D, 0x64, 0x24, 0x08,
+    0x5C, 0xC3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+// Values the hooks load, as in dllmain.cpp.
+static float fValue = 1.25f;
+static uint64_t iValue = 0x1234;
+static bool bCondition = true;
+
+// Mid hook destinations doing what the converted hooks did.
+static HOOK_ABI void LoadXMM0(SafetyHookContext& ctx) { ctx.xmm0.f32[0] = fValue; }
+static HOOK_ABI void LoadXMM0If(SafetyHookContext& ctx)
+{
+    if (bCondition)
+        ctx.xmm0.f32[0] = fValue;
+}
+static HOOK_ABI void LoadRAX(SafetyHookContext& ctx) { ctx.rax = iValue; }
+
+// Bump allocator over one executable block.
+class CodeBuffer
+{
+public:
+    CodeBuffer(size_t size) : m_size(size)
+    {
+#ifdef _WIN32
+        m_base = static_cast<uint8_t*>(VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+#else
+        void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        m_base = (base == MAP_FAILED) ? nullptr : static_cast<uint8_t*>(base);
+#endif
+    }
+
+    explicit operator bool() const { return m_base != nullptr; }
+
+    // Copies bytes in on a fresh 64 byte line, like separate allocations would be.
+    uint8_t* Place(const uint8_t* bytes, size_t size)
+    {
+        m_used = (m_used + 63) & ~size_t(63);
+        if (m_used + size > m_size)
+            return nullptr;
+        uint8_t* address = m_base + m_used;
+        memcpy(address, bytes, size);
+        m_used += size;
+        return address;
+    }
+
+private:
+    uint8_t* m_base = nullptr;
+    size_t m_size;
+    size_t m_used = 0;
+};
+
+static uint8_t* PlaceJump(CodeBuffer& buffer, const uint8_t* destination)
+{
+    // jmp qword ptr [rip+0]
+    uint8_t code[14] = { 0xFF, 0x25, 0x00, 0x00, 0x00, 0x00 };
+    memcpy(code + 6, &destination, sizeof(destination));
+    return buffer.Place(code, sizeof(code));
+}
+
+static uint8_t* PlaceMidHook(CodeBuffer& buffer, HOOK_ABI void (*destination)(SafetyHookContext&), const uint8_t* trampoline)
+{
+    std::array<uint8_t, MidHookStub.size()> code = MidHookStub;
+    memcpy(code.data() + code.size() - 16, &destination, sizeof(destination));
+    memcpy(code.data() + code.size() - 8, &trampoline, sizeof(trampoline));
+    uint8_t* stub = buffer.Place(code.data(), code.size());
+    return stub ? PlaceJump(buffer, stub) : nullptr;
+}
+
+static uint8_t* PlaceRegisterLoad(CodeBuffer& buffer, Hooks::Register reg, const void* source, const bool* condition, const uint8_t* trampoline)
+{
+    Hooks::RegisterLoadStub emitted = Hooks::EmitRegisterLoad(reg, source, condition);
+    memcpy(emitted.code.data() + emitted.trampolineSlot, &trampoline, sizeof(trampoline));
+    uint8_t* stub = buffer.Place(emitted.code.data(), emitted.code.size());
+    return stub ? PlaceJump(buffer, stub) : nullptr;
+}
+
+// Best of several runs, in nanoseconds per call. Also checks every call returned the expected value.
+template<typename Result>
+static double Time(const uint8_t* site, Result expected, size_t calls, bool& bCorrect)
+{
+    auto fn = reinterpret_cast<Result(*)()>(const_cast<uint8_t*>(site));
+    double best = 1e30;
+    for (int run = 0; run < 5; ++run) {
+        size_t matches = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; ++i)
+            matches += (fn() == expected);
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(calls));
+        bCorrect = bCorrect && matches == calls;
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    const size_t calls = (argc > 1) ? std::stoull(argv[1]) : 10000000;
+
+    CodeBuffer buffer(64 * 1024);
+    if (!buffer) {
+        std::cerr << "Failed to allocate executable memory.\n";
+        return 1;
+    }
+
+    const uint8_t ret = 0xC3;
+    const uint8_t* trampoline = buffer.Place(&ret, 1);
+
+    struct Case
+    {
+        const char* name;
+        const uint8_t* mid;
+        const uint8_t* load;
+        bool bFloat;
+    };
+    const Case cases[] = {
+        { "XMM0", PlaceMidHook(buffer, LoadXMM0, trampoline), PlaceRegisterLoad(buffer, Hooks::Register::XMM0, &fValue, nullptr, trampoline), true },
+        { "XMM0 conditional", PlaceMidHook(buffer, LoadXMM0If, trampoline), PlaceRegisterLoad(buffer, Hooks::Register::XMM0, &fValue, &bCondition, trampoline), true },
+        { "RAX", PlaceMidHook(buffer, LoadRAX, trampoline), PlaceRegisterLoad(buffer, Hooks::Register::RAX, &iValue, nullptr, trampoline), false },
+    };
+
+    // Site that jumps straight to the trampoline: the call, jump and return every case pays.
+    bool bCorrect = true;
+    const double baseline = Time<uint64_t>(PlaceJump(buffer, trampoline), 0, calls, bCorrect);
+    bCorrect = true;
+
+    printf("%zu calls per run, best of 5. Site with no hook: %.2fns per call.\n\n", calls, baseline);
+    printf("%-18s %14s %14s %10s\n", "Load", "Mid hook (ns)", "Stub (ns)", "Speedup");
+    for (const Case& c : cases) {
+        bool bMidCorrect = true, bLoadCorrect = true;
+        const double mid = c.bFloat ? Time<float>(c.mid, fValue, calls, bMidCorrect) : Time<uint64_t>(c.mid, iValue, calls, bMidCorrect);
+        const double load = c.bFloat ? Time<float>(c.load, fValue, calls, bLoadCorrect) : Time<uint64_t>(c.load, iValue, calls, bLoadCorrect);
+        printf("%-18s %14.2f %14.2f %9.1fx%s\n", c.name, mid, load, (mid - baseline) / std::max(load - baseline, 0.01),
+            (bMidCorrect && bLoadCorrect) ? "" : "  WRONG VALUE");
+        bCorrect = bCorrect && bMidCorrect && bLoadCorrect;
+    }
+    printf("\nSpeedup compares the time each hook adds over the unhooked site.\n");
+    return bCorrect ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+// Checks the controller polling logic (src/input.hpp) against a stub device: the stick filter, the seqlock mailbox
+// (including a reader/writer stress run for torn reads) and the poller's reconnect and packet numbering.
+//   g++ -std=c++20 -O2 -pthread -o input_check tools/input_check.cpp
+//   input_check [stress seconds]
+
+#include "../src/input.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+static void Check(bool condition, const std::string& what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what.c_str());
+        ++failures;
+    }
+}
+
+static Input::Pad Stick(int16_t x, int16_t y)
+{
+    Input::Pad pad{};
+    pad.leftX = x;
+    pad.leftY = y;
+    return pad;
+}
+
+static void CheckFilter()
+{
+    Input::Filter filter{};
+
+    // Off: sticks pass through untouched, including the extremes.
+    for (int16_t value : { int16_t(-32768), int16_t(-1), int16_t(0), int16_t(1), int16_t(32767) }) {
+        const Input::Pad pad = filter.Process(Stick(value, value), {});
+        Check(pad.leftX == value && pad.leftY == value, "no filter changed " + std::to_string(value));
+    }
+
+    // Deadzone: inside is zero, the edge of the range is still full deflection, direction is kept.
+    const Input::FilterSettings deadzone{ 8000, 0.00f };
+    Check(filter.Process(Stick(5000, 5000), deadzone).leftX == 0, "(5000, 5000) is inside an 8000 radial deadzone");
+    Check(filter.Process(Stick(8000, 0), deadzone).leftX == 0, "the deadzone boundary maps to 0");
+    Check(filter.Process(Stick(32767, 0), deadzone).leftX == 32767, "full deflection stays full with a deadzone");
+    Check(filter.Process(Stick(-32768, 0), deadzone).leftX == -32767, "full negative deflection clamps to -32767");
+    {
+        const Input::Pad pad = filter.Process(Stick(20000, -20000), deadzone);
+        Check(pad.leftX > 0 && pad.leftX == -pad.leftY, "diagonal keeps its direction (" + std::to_string(pad.leftX) + ", " + std::to_string(pad.leftY) + ")");
+    }
+    int16_t previous = 0;
+    bool bMonotonic = true;
+    for (int x = 8001; x <= 32767; x += 97) {
+        const int16_t out = filter.Process(Stick(static_cast<int16_t>(x), 0), deadzone).leftX;
+        bMonotonic &= out >= previous;
+        previous = out;
+    }
+    Check(bMonotonic, "deadzone rescaling is monotonic");
+    Check(filter.Process(Stick(0, 0), Input::FilterSettings{ 99999, 0.00f }).leftX == 0, "an oversized deadzone is clamped, not divided by zero");
+
+    // Smoothing: a step converges towards the target and never overshoots, and Reset forgets the history.
+    const Input::FilterSettings smoothing{ 0, 0.50f };
+    filter.Reset();
+    int16_t x = 0;
+    bool bRising = true;
+    for (int i = 0; i < 32; ++i) {
+        const int16_t next = filter.Process(Stick(32767, 0), smoothing).leftX;
+        bRising &= next >= x;
+        x = next;
+    }
+    Check(bRising && x >= 32766, "smoothing converges to a held stick without oscillating (" + std::to_string(x) + ")");
+    Check(filter.Process(Stick(0, 0), smoothing).leftX > 10000, "smoothing lags a release");
+    filter.Reset();
+    Check(filter.Process(Stick(0, 0), smoothing).leftX == 0, "Reset clears the smoothing history");
+    Check(filter.Process(Stick(1000, 0), Input::FilterSettings{ 0, 5.00f }).leftX == 100, "smoothing weight is clamped to 0.9");
+}
+
+static void CheckMailbox(double stressSeconds)
+{
+    Input::Mailbox mailbox{};
+    Input::Pad pad{};
+    Check(mailbox.Read(pad) == Input::NotConnected, "an empty mailbox reads as not connected");
+
+    Input::Pad written = Stick(123, -456);
+    written.packet = 7;
+    written.buttons = 0x1234;
+    mailbox.Publish(written, Input::Success);
+    Check(mailbox.Read(pad) == Input::Success && memcmp(&pad, &written, sizeof(pad)) == 0, "a published pad reads back");
+
+    // Every published pad is derived from one counter, so a torn read shows up as fields that disagree.
+    auto make = [](uint32_t n) {
+        Input::Pad p{};
+        p.packet = n;
+        p.buttons = static_cast<uint16_t>(n);
+        p.leftTrigger = static_cast<uint8_t>(n);
+        p.rightTrigger = static_cast<uint8_t>(n >> 8);
+        p.leftX = static_cast<int16_t>(n);
+        p.leftY = static_cast<int16_t>(~n);
+        p.rightX = static_cast<int16_t>(n >> 16);
+        p.rightY = static_cast<int16_t>(n * 3);
+        return p;
+        };
+
+    std::atomic<bool> bStop{ false };
+    std::thread writer([&] {
+        for (uint32_t n = 1; !bStop.load(std::memory_order_relaxed); ++n)
+            mailbox.Publish(make(n), n & 1);
+        });
+
+    std::vector<std::thread> readers{};
+    std::atomic<uint64_t> reads{ 0 }, torn{ 0 }, backwards{ 0 };
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            uint32_t last = 0;
+            while (!bStop.load(std::memory_order_relaxed)) {
+                Input::Pad p{};
+                const uint32_t result = mailbox.Read(p);
+                const Input::Pad expected = make(p.packet);
+                if (memcmp(&p, &expected, sizeof(p)) != 0 || result != (p.packet & 1))
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                if (p.packet < last)
+                    backwards.fetch_add(1, std::memory_order_relaxed);
+                last = p.packet;
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+            });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(stressSeconds));
+    bStop.store(true);
+    writer.join();
+    for (auto& reader : readers)
+        reader.join();
+    Check(torn.load() == 0, std::to_string(torn.load()) + " torn reads out of " + std::to_string(reads.load()));
+    Check(backwards.load() == 0, std::to_string(backwards.load()) + " reads went back to an older pad");
+    printf("Mailbox stress: %llu reads in %.1fs, none torn.\n", (unsigned long long)reads.load(), stressSeconds);
+}
+
+// Stand-in for XInput: slot 0 has a pad whose stick follows a script, slot 1 connects later, slots 2 and 3 stay empty.
+struct StubDevice
+{
+    uint32_t step = 0;
+    uint32_t connectSlot1At = 5;
+    uint32_t calls[Input::MaxPads]{};
+    int16_t stick = 0;
+
+    uint32_t GetState(uint32_t index, Input::Pad& pad)
+    {
+        ++calls[index];
+        if (index == 0) {
+            pad = Stick(stick, 0);
+            pad.packet = 1000 + step;   // The device bumps its packet every call, the poller must not pass that on
+            return Input::Success;
+        }
+        if (index == 1 && step >= connectSlot1At) {
+            pad = Stick(0, 0);
+            return Input::Success;
+        }
+        return Input::NotConnected;
+    }
+};
+
+static void CheckPoller()
+{
+    StubDevice device{};
+    Input::Poller<StubDevice> poller(device);
+    const uint32_t reconnectInterval = 4;
+
+    std::vector<uint32_t> packets{};
+    for (device.step = 0; device.step < 12; ++device.step) {
+        device.stick = (device.step >= 3 && device.step < 6) ? 20000 : 0;
+        poller.Step({}, reconnectInterval);
+        Input::Pad pad{};
+        Check(poller.mailboxes[0].Read(pad) == Input::Success, "slot 0 reads as connected");
+        packets.push_back(pad.packet);
+    }
+
+    // Packet numbers only change when the state does: at step 3 (stick moved) and step 6 (released).
+    const std::vector<uint32_t> expected = { 0, 0, 0, 1, 1, 1, 2, 2, 2, 2, 2, 2 };
+    Check(packets == expected, "slot 0 packet numbers follow state changes, not device calls");
+
+    // Empty slots are only polled every reconnectInterval steps: steps 0, 4 and 8.
+    Check(device.calls[0] == 12, "a connected slot is polled every step (" + std::to_string(device.calls[0]) + ")");
+    Check(device.calls[2] == 3 && device.calls[3] == 3, "empty slots are polled every " + std::to_string(reconnectInterval) + " steps ("
+        + std::to_string(device.calls[2]) + ", " + std::to_string(device.calls[3]) + ")");
+
+    // Slot 1 connects at step 5 but is only seen at the next retry (step 8), then polled every step.
+    Check(device.calls[1] == 3 + 3, "slot 1 is picked up at the next retry and then polled every step (" + std::to_string(device.calls[1]) + ")");
+    Input::Pad pad{};
+    Check(poller.mailboxes[1].Read(pad) == Input::Success, "slot 1 reads as connected once found");
+    Check(poller.mailboxes[2].Read(pad) == Input::NotConnected && pad.leftX == 0, "an empty slot reads as not connected");
+}
+
+int main(int argc, char** argv)
+{
+    const double stressSeconds = (argc > 1) ? std::stod(argv[1]) : 2.0;
+    CheckFilter();
+    CheckMailbox(stressSeconds);
+    CheckPoller();
+    printf("%s (%d failure(s))\n", failures ? "FAILED" : "All checks passed", failures);
+    return failures ? 1 : 0;
+}
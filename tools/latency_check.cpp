@@ -0,0 +1,175 @@
+// Checks the render queue limiter (src/latency.hpp) against a fake GPU and clock: the queue never holds more than the
+// configured depth, present to GPU done follows the depth, and a CPU-bound game is never held back. Also checks that
+// Backoff, the wait used when there is no fence, gives the core away while it waits.
+//   g++ -std=c++20 -O2 -pthread -o latency_check tools/latency_check.cpp
+//   latency_check
+
+#include "../src/latency.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+static void Check(bool condition, const std::string& what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what.c_str());
+        ++failures;
+    }
+}
+
+// Simulated time, shared by the fake GPU and clock.
+struct FakeClock
+{
+    const double* now;
+    double Now() const { return *now; }
+};
+
+// A GPU that runs submitted frames back to back, each taking gpuTime. Waiting just moves simulated time on.
+struct FakeGpu
+{
+    using Token = size_t;
+
+    double* now;
+    double gpuTime;
+    double busyUntil = 0.0;
+    std::vector<double> doneAt{};
+
+    Token Issue()
+    {
+        busyUntil = std::max(*now, busyUntil) + gpuTime;
+        doneAt.push_back(busyUntil);
+        return doneAt.size() - 1;
+    }
+
+    bool Done(Token token) const { return *now >= doneAt[token]; }
+    void Wait(Token token) { *now = std::max(*now, doneAt[token]); }
+};
+
+struct Run
+{
+    double fps;
+    double presentToDone;   // Average over the measured frames
+    double waited;          // Average per frame
+    size_t maxQueued;
+};
+
+// Runs frames of cpuTime CPU work each, then measures the last half once the queue has settled.
+static Run Simulate(size_t depth, double cpuTime, double gpuTime, size_t frames = 400)
+{
+    double now = 0.0;
+    FakeGpu gpu{ &now, gpuTime };
+    Latency::Limiter<FakeGpu, FakeClock> limiter(gpu, FakeClock{ &now }, depth);
+
+    Run run{};
+    Latency::Summary summary{};
+    double start = 0.0;
+    for (size_t frame = 0; frame < frames; ++frame) {
+        const bool bMeasured = frame >= frames / 2;
+        if (frame == frames / 2)
+            start = now;
+
+        now += cpuTime;
+        limiter.BeforePresent();
+        const double waited = limiter.AfterPresent([&](const Latency::Frame& retired) {
+            if (bMeasured)
+                summary.Add(retired);
+            });
+        if (bMeasured)
+            summary.waited += waited;
+        run.maxQueued = std::max(run.maxQueued, limiter.Queued());
+    }
+
+    const double measured = static_cast<double>(frames - frames / 2);
+    run.fps = measured / (now - start);
+    run.presentToDone = summary.frames ? summary.presentToDone / static_cast<double>(summary.frames) : 0.0;
+    run.waited = summary.waited / measured;
+    return run;
+}
+
+static std::string Describe(size_t depth, const Run& run)
+{
+    char text[160];
+    snprintf(text, sizeof(text), "depth %zu: %.1f fps, present to done %.1fms, waited %.1fms, max queued %zu", depth, run.fps,
+        run.presentToDone * 1000.0, run.waited * 1000.0, run.maxQueued);
+    return text;
+}
+
+static void CheckDepth()
+{
+    double now = 0.0;
+    FakeGpu gpu{ &now, 0.01 };
+    Latency::Limiter<FakeGpu, FakeClock> limiter(gpu, FakeClock{ &now }, 0);
+    Check(limiter.Depth() == 1, "depth 0 is clamped to 1");
+    limiter.SetDepth(99);
+    Check(limiter.Depth() == Latency::MaxDepth, "depth 99 is clamped to MaxDepth");
+}
+
+static void CheckGpuBound()
+{
+    // GPU-bound at 100fps: 10ms per frame on the GPU, 4ms of CPU work. After each present the CPU waits until depth frames are
+    // left, the last of them being the one just presented, so the GPU never runs dry. A frame starts on the GPU once the one
+    // before it is done, 6ms after its present, and then waits behind depth - 1 frames queued after it: depth * 10ms + 6ms.
+    for (size_t depth = 1; depth <= Latency::MaxDepth; ++depth) {
+        const Run run = Simulate(depth, 0.004, 0.010);
+        const double expected = depth * 0.010 + 0.006;
+        printf("GPU-bound %s\n", Describe(depth, run).c_str());
+        Check(run.maxQueued <= depth, "GPU-bound " + Describe(depth, run) + ": queue exceeded the depth");
+        Check(std::abs(run.presentToDone - expected) < 0.0005, "GPU-bound " + Describe(depth, run) + ": expected present to done of "
+            + std::to_string(expected * 1000.0) + "ms");
+        Check(std::abs(run.waited - 0.006) < 0.0005, "GPU-bound " + Describe(depth, run) + ": expected to wait out the 6ms the GPU is behind");
+        Check(run.fps > 99.0 && run.fps < 101.0, "GPU-bound " + Describe(depth, run) + ": the GPU wasn't kept busy");
+    }
+}
+
+static void CheckCpuBound()
+{
+    // CPU-bound: 10ms of CPU work, 5ms on the GPU. Each frame is done before the next present, where the limiter sees it
+    // finished, so nothing waits and present to done is one frame time whatever the depth.
+    for (size_t depth = 1; depth <= Latency::MaxDepth; ++depth) {
+        const Run run = Simulate(depth, 0.010, 0.005);
+        printf("CPU-bound %s\n", Describe(depth, run).c_str());
+        Check(run.maxQueued == 1, "CPU-bound " + Describe(depth, run) + ": frames piled up");
+        Check(run.waited == 0.0, "CPU-bound " + Describe(depth, run) + ": the limiter held back a CPU-bound game");
+        Check(run.fps > 99.0 && run.fps < 101.0, "CPU-bound " + Describe(depth, run) + ": frame rate changed");
+        Check(std::abs(run.presentToDone - 0.010) < 0.0005, "CPU-bound " + Describe(depth, run) + ": present to done isn't one frame time");
+    }
+}
+
+static void CheckBackoff()
+{
+    // Wait 200ms for a flag the way GpuSignal does without a fence, and see how much of it was spent on the CPU.
+    std::atomic<bool> bDone{ false };
+    std::thread setter([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        bDone.store(true);
+        });
+
+    const std::clock_t cpuStart = std::clock();
+    const auto start = std::chrono::steady_clock::now();
+    Latency::Backoff backoff{};
+    while (!bDone.load())
+        backoff.Pause();
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    setter.join();
+
+    printf("Backoff: waited %.0fms using %.1fms of CPU.\n", wall * 1000.0, cpu * 1000.0);
+    Check(wall < 0.25, "Backoff noticed the flag " + std::to_string(wall * 1000.0) + "ms in, more than 50ms late");
+    Check(cpu < wall * 0.25, "Backoff used " + std::to_string(cpu * 1000.0) + "ms of CPU over a " + std::to_string(wall * 1000.0) + "ms wait");
+}
+
+int main()
+{
+    CheckDepth();
+    CheckGpuBound();
+    CheckCpuBound();
+    CheckBackoff();
+    printf("%s (%d failure(s))\n", failures ? "FAILED" : "All checks passed", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,305 @@
+// Generates the shortest signature that uniquely matches an RVA in a PE64 image, in the format used by src/signatures.hpp.
+// Instructions are decoded with the bundled Zydis, and only bytes that move between builds are wildcarded: relative
+// branch/call targets, RIP-relative displacements and RSP/RBP stack offsets. Everything else, including opcodes and
+// immediate constants, is kept.
+// Candidates start at the RVA and at the instructions just before it (found by decoding from the function start in .pdata),
+// and are ranked by the estimated cost of rejecting a position with the byte-by-byte scanner in src/pattern.hpp.
+// Links against the same amalgamated Zydis as the fix:
+//   gcc -c -O2 -I external/safetyhook -o Zydis.o external/safetyhook/Zydis.c
+//   g++ -std=c++20 -O2 -I external/safetyhook -o sig_gen tools/sig_gen.cpp Zydis.o
+//   sig_gen METAPHOR.exe <rva> [max length]
+//   sig_gen METAPHOR.exe costs
+
+#include "../src/pattern.hpp"
+#include "../src/signatures.hpp"
+
+#include <Zydis.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+struct Image
+{
+    std::vector<uint8_t> mapped;    // Laid out at RVAs, as the loader would
+    uint32_t exceptionRVA = 0;
+    uint32_t exceptionSize = 0;
+};
+
+static uint16_t Get16(const std::vector<uint8_t>& in, size_t at) { uint16_t value; memcpy(&value, &in[at], sizeof(value)); return value; }
+static uint32_t Get32(const std::vector<uint8_t>& in, size_t at) { uint32_t value; memcpy(&value, &in[at], sizeof(value)); return value; }
+
+static bool Load(const std::string& path, Image& image)
+{
+    std::ifstream in(path, std::ios::binary);
+    const std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (file.size() < 0x40 || Get16(file, 0) != 0x5A4D)
+        return false;
+    const size_t nt = Get32(file, 0x3C);
+    if (nt + 24 + 240 > file.size() || Get32(file, nt) != 0x00004550 || Get16(file, nt + 24) != 0x20B)
+        return false;
+
+    const uint16_t sections = Get16(file, nt + 6);
+    const size_t table = nt + 24 + Get16(file, nt + 20);
+    const uint32_t sizeOfImage = Get32(file, nt + 24 + 56);
+    const uint32_t sizeOfHeaders = Get32(file, nt + 24 + 60);
+    if (table + sections * 40 > file.size() || sizeOfHeaders > file.size())
+        return false;
+    image.exceptionRVA = Get32(file, nt + 24 + 112 + 3 * 8);     // IMAGE_DIRECTORY_ENTRY_EXCEPTION
+    image.exceptionSize = Get32(file, nt + 24 + 112 + 3 * 8 + 4);
+
+    image.mapped.assign(sizeOfImage, 0);
+    std::copy(file.begin(), file.begin() + std::min<size_t>(sizeOfHeaders, sizeOfImage), image.mapped.begin());
+    for (uint16_t i = 0; i < sections; ++i) {
+        const size_t at = table + i * 40;
+        const uint32_t virtualSize = Get32(file, at + 8);
+        const uint32_t rva = Get32(file, at + 12);
+        const uint32_t rawSize = Get32(file, at + 16);
+        const uint32_t raw = Get32(file, at + 20);
+        if (raw + static_cast<size_t>(rawSize) > file.size() || rva + static_cast<size_t>(std::min(rawSize, virtualSize)) > sizeOfImage)
+            return false;
+        std::copy_n(file.begin() + raw, std::min(rawSize, virtualSize), image.mapped.begin() + rva);
+    }
+    return true;
+}
+
+// Start of the function containing rva from .pdata, or rva itself for leaf functions.
+static uint32_t FunctionStart(const Image& image, uint32_t rva)
+{
+    if (!image.exceptionRVA || image.exceptionRVA + static_cast<size_t>(image.exceptionSize) > image.mapped.size())
+        return rva;
+    for (uint32_t at = image.exceptionRVA; at + 12 <= image.exceptionRVA + image.exceptionSize; at += 12) {
+        const uint32_t begin = Get32(image.mapped, at);
+        const uint32_t end = Get32(image.mapped, at + 4);
+        if (rva >= begin && rva < end)
+            return begin;
+    }
+    return rva;
+}
+
+// Pattern bytes for one instruction, -1 where the byte is relocatable.
+static bool DecodePattern(const ZydisDecoder& decoder, const Image& image, uint32_t rva, std::vector<int>& pattern)
+{
+    ZydisDecodedInstruction ix{};
+    ZydisDecodedOperand operands[ZYDIS_MAX_OPERAND_COUNT]{};
+    if (rva >= image.mapped.size() || !ZYAN_SUCCESS(ZydisDecoderDecodeFull(&decoder, image.mapped.data() + rva, image.mapped.size() - rva, &ix, operands)))
+        return false;
+
+    std::vector<bool> wildcard(ix.length, false);
+    auto wildcardBytes = [&](uint8_t offset, uint8_t bits) {
+        for (uint8_t i = 0; i < bits / 8 && offset + i < ix.length; ++i)
+            wildcard[offset + i] = true;
+        };
+
+    for (const auto& imm : ix.raw.imm) {
+        if (imm.size && imm.is_relative)
+            wildcardBytes(imm.offset, imm.size);
+    }
+    if (ix.raw.disp.size) {
+        for (uint8_t i = 0; i < ix.operand_count; ++i) {
+            const auto& operand = operands[i];
+            if (operand.type != ZYDIS_OPERAND_TYPE_MEMORY)
+                continue;
+            const ZydisRegister base = operand.mem.base;
+            if (base == ZYDIS_REGISTER_RIP || base == ZYDIS_REGISTER_RSP || base == ZYDIS_REGISTER_RBP)
+                wildcardBytes(ix.raw.disp.offset, ix.raw.disp.size);
+        }
+    }
+
+    for (uint8_t i = 0; i < ix.length; ++i)
+        pattern.push_back(wildcard[i] ? -1 : image.mapped[rva + i]);
+    return true;
+}
+
+// Expected byte comparisons per scanned position: each byte is only compared if every earlier byte matched.
+static double Cost(const std::vector<int>& pattern, const double frequency[256])
+{
+    double cost = 0.0;
+    double reach = 1.0;
+    for (int byte : pattern) {
+        cost += reach;
+        if (byte != -1)
+            reach *= frequency[byte];
+    }
+    return cost;
+}
+
+// Number of matches in the image, stopping at limit. Walks the pattern's rarest fixed byte with memchr.
+static size_t CountMatches(const Image& image, const std::vector<int>& pattern, const double frequency[256], size_t limit)
+{
+    size_t anchor = pattern.size();
+    for (size_t j = 0; j < pattern.size(); ++j) {
+        if (pattern[j] != -1 && (anchor == pattern.size() || frequency[pattern[j]] < frequency[pattern[anchor]]))
+            anchor = j;
+    }
+    if (anchor == pattern.size() || image.mapped.size() < pattern.size())
+        return limit;
+
+    size_t count = 0;
+    const uint8_t* bytes = image.mapped.data();
+    const uint8_t* p = bytes + anchor;
+    const uint8_t* last = bytes + image.mapped.size() - pattern.size() + anchor;
+    while (count < limit && p <= last && (p = static_cast<const uint8_t*>(memchr(p, pattern[anchor], last - p + 1)))) {
+        const uint8_t* candidate = p - anchor;
+        bool found = true;
+        for (size_t j = 0; j < pattern.size() && found; ++j)
+            found = pattern[j] == -1 || candidate[j] == pattern[j];
+        count += found;
+        ++p;
+    }
+    return count;
+}
+
+static std::string Format(const std::vector<int>& pattern)
+{
+    std::string signature{};
+    char byte[4];
+    for (int value : pattern) {
+        if (!signature.empty())
+            signature += ' ';
+        if (value == -1) {
+            signature += "??";
+        }
+        else {
+            snprintf(byte, sizeof(byte), "%02X", value);
+            signature += byte;
+        }
+    }
+    return signature;
+}
+
+static void TrimTrailingWildcards(std::vector<int>& pattern)
+{
+    while (!pattern.empty() && pattern.back() == -1)
+        pattern.pop_back();
+}
+
+struct Candidate
+{
+    uint32_t start;
+    std::vector<int> pattern;
+    double cost;
+};
+
+static int Generate(const Image& image, uint32_t rva, size_t maxLength)
+{
+    if (rva >= image.mapped.size()) {
+        std::cerr << "RVA is outside the image." << std::endl;
+        return 1;
+    }
+
+    ZydisDecoder decoder{};
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+
+    double frequency[256]{};
+    for (uint8_t byte : image.mapped)
+        frequency[byte] += 1.0 / static_cast<double>(image.mapped.size());
+
+    // Instruction boundaries from the function start up to the RVA. Only the last few are worth starting from.
+    std::vector<uint32_t> starts{};
+    for (uint32_t at = FunctionStart(image, rva); at < rva;) {
+        std::vector<int> instruction{};
+        if (!DecodePattern(decoder, image, at, instruction))
+            break;
+        starts.push_back(at);
+        at += static_cast<uint32_t>(instruction.size());
+    }
+    if (starts.size() > 8)
+        starts.erase(starts.begin(), starts.end() - 8);
+    starts.push_back(rva);
+
+    std::vector<Candidate> candidates{};
+    for (uint32_t start : starts) {
+        // Grow an instruction at a time until the pattern is unique...
+        std::vector<int> pattern{};
+        size_t previous = 0;
+        bool bUnique = false;
+        for (uint32_t at = start; pattern.size() < maxLength;) {
+            previous = pattern.size();
+            if (!DecodePattern(decoder, image, at, pattern))
+                break;
+            at = start + static_cast<uint32_t>(pattern.size());
+
+            std::vector<int> trimmed = pattern;
+            TrimTrailingWildcards(trimmed);
+            if (CountMatches(image, trimmed, frequency, 2) == 1) {
+                bUnique = true;
+                break;
+            }
+        }
+        if (!bUnique)
+            continue;
+
+        // ...then drop bytes from the end of the last instruction while it stays unique.
+        TrimTrailingWildcards(pattern);
+        while (pattern.size() > previous + 1) {
+            std::vector<int> shorter(pattern.begin(), pattern.end() - 1);
+            TrimTrailingWildcards(shorter);
+            if (shorter.empty() || CountMatches(image, shorter, frequency, 2) != 1)
+                break;
+            pattern = shorter;
+        }
+        candidates.push_back({ start, pattern, Cost(pattern, frequency) });
+    }
+
+    if (candidates.empty()) {
+        std::printf("No unique signature within %zu bytes of any start near %x.\n", maxLength, rva);
+        return 2;
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.cost != b.cost ? a.cost < b.cost : a.pattern.size() < b.pattern.size();
+        });
+
+    std::printf("%-4s %-10s %-6s %-6s %-8s %s\n", "Rank", "Cmp/byte", "Length", "Fixed", "Hook at", "Signature");
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const Candidate& candidate = candidates[i];
+        const size_t fixed = std::count_if(candidate.pattern.begin(), candidate.pattern.end(), [](int byte) { return byte != -1; });
+        std::printf("%-4zu %-10.4f %-6zu %-6zu +0x%-5x \"%s\"\n", i + 1, candidate.cost, candidate.pattern.size(), fixed, rva - candidate.start,
+            Format(candidate.pattern).c_str());
+    }
+    return 0;
+}
+
+// Estimated cost and match count of every signature the fix uses, most expensive first.
+static int Costs(const Image& image)
+{
+    double frequency[256]{};
+    for (uint8_t byte : image.mapped)
+        frequency[byte] += 1.0 / static_cast<double>(image.mapped.size());
+
+    std::vector<std::pair<double, const char*>> costs{};
+    for (const char* signature : Signatures::All)
+        costs.push_back({ Cost(Memory::PatternToBytes(signature), frequency), signature });
+    std::sort(costs.begin(), costs.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::printf("%-10s %-7s %-6s %s\n", "Cmp/byte", "Matches", "Length", "Signature");
+    for (const auto& [cost, signature] : costs) {
+        const auto pattern = Memory::PatternToBytes(signature);
+        std::printf("%-10.4f %-7zu %-6zu \"%s\"\n", cost, CountMatches(image, pattern, frequency, 10), pattern.size(), signature);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::cerr << "Usage: sig_gen <image> <rva> [max length]" << std::endl;
+        std::cerr << "       sig_gen <image> costs" << std::endl;
+        return 1;
+    }
+
+    Image image{};
+    if (!Load(argv[1], image)) {
+        std::cerr << "Could not load " << argv[1] << " as a PE64 image." << std::endl;
+        return 1;
+    }
+
+    if (std::string(argv[2]) == "costs")
+        return Costs(image);
+    return Generate(image, static_cast<uint32_t>(std::stoul(argv[2], nullptr, 16)), (argc > 3) ? std::stoul(argv[3]) : 64);
+}
@@ -0,0 +1,516 @@
+// Builds a synthetic PE64 image with every signature from src/signatures.hpp planted at known RVAs, so the scanners the
+// fix uses can be checked and timed at game scale without the game.
+// The code section is filled with x86-64 shaped code (prologues, REX/VEX prefixes, calls, short jumps, CC padding) and
+// described by a .pdata table. Each signature also gets near-miss decoys: copies with a single fixed byte changed.
+//   g++ -std=c++20 -O2 -o synth_image tools/synth_image.cpp
+//   synth_image generate synth.exe [size MB] [decoys per signature] [seed]
+//   synth_image verify synth.exe [iterations]
+// generate also writes synth.exe.sites, listing every planted site and decoy. verify maps the image the way the loader would
+// and runs the fix's own code on it: SignatureCache's lookup order and on-disk prediction (src/pattern.hpp) and the
+// per-function scan (src/functions.hpp). It checks each finds exactly the planted sites and nothing else, then times a full
+// startup's worth of scans.
+
+#include "../src/functions.hpp"
+#include "../src/pattern.hpp"
+#include "../src/signatures.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+static const char* SignatureNames[] = {
+    "ShadowResolution", "ShadowTexShift", "CSMSplits", "ResolutionScale", "AOResolution", "LODDistance", "FoliageDistance",
+    "OutlineShader", "IntroSkip", "DemoIntroSkip", "CurrentResolution", "ResolutionFix", "ShadowAspectRatio",
+    "CameraPaneAspectRatio", "CameraPane", "GlobalFOV", "GameplayFOV", "HUDWidth", "Fades", "PauseCapture", "HUDOffset",
+    "HUDOffsetClip", "ScreenPosHor", "ScreenPosVert", "ElementSize", "FadeWipe", "Movies", "FramerateCap", "XInputGetState",
+    "KeyboardIcons", "MouseIcons1", "MouseIcons2", "CameraShake",
+};
+static_assert(std::size(SignatureNames) == std::size(Signatures::All));
+
+static constexpr size_t SignatureCount = std::size(Signatures::All);
+static constexpr uint32_t FileAlignment = 0x200;
+static constexpr uint32_t SectionAlignment = 0x1000;
+static constexpr uint32_t HeadersSize = 0x400;
+static constexpr uint32_t TextRVA = SectionAlignment;
+static constexpr uint32_t CodeCharacteristics = 0x60000020;    // IMAGE_SCN_CNT_CODE | MEM_EXECUTE | MEM_READ
+static constexpr uint32_t ReadOnlyCharacteristics = 0x40000040; // IMAGE_SCN_CNT_INITIALIZED_DATA | MEM_READ
+
+static uint32_t AlignUp(uint32_t value, uint32_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+// xorshift64*
+class Random
+{
+public:
+    explicit Random(uint64_t seed) : m_state(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+
+    uint64_t Next()
+    {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 0x2545F4914F6CDD1Dull;
+    }
+
+    uint32_t Below(uint32_t bound) { return static_cast<uint32_t>((Next() >> 32) % bound); }
+    uint8_t Byte() { return static_cast<uint8_t>(Next() >> 56); }
+
+private:
+    uint64_t m_state;
+};
+
+struct Site
+{
+    bool bDecoy;
+    size_t signature;
+    uint32_t offset;    // From the start of .text
+    size_t flipped;     // Pattern index of the changed byte, decoys only
+};
+
+// Emits functions shaped like MSVC x64 output until the buffer is full. Returns {begin, end} of every function.
+static std::vector<std::pair<uint32_t, uint32_t>> FillCode(std::vector<uint8_t>& text, Random& random)
+{
+    std::vector<std::pair<uint32_t, uint32_t>> functions{};
+    size_t at = 0;
+    auto emit = [&](std::initializer_list<uint8_t> bytes) { for (uint8_t byte : bytes) if (at < text.size()) text[at++] = byte; };
+    auto emitRandom = [&](size_t count) { for (size_t i = 0; i < count && at < text.size(); ++i) text[at++] = random.Byte(); };
+    auto modrm = [&]() { return static_cast<uint8_t>(0x40 | (random.Below(8) << 3) | random.Below(8)); };   // [reg+disp8]
+
+    while (at + 64 < text.size()) {
+        const uint32_t begin = static_cast<uint32_t>(at);
+        switch (random.Below(3)) {
+        case 0: emit({ 0x48, 0x89, 0x5C, 0x24, 0x08, 0x57, 0x48, 0x83, 0xEC, 0x20 }); break;
+        case 1: emit({ 0x40, 0x53, 0x48, 0x83, 0xEC, 0x20 }); break;
+        default: emit({ 0x48, 0x83, 0xEC, 0x28 }); break;
+        }
+
+        const uint32_t instructions = 8 + random.Below(120);
+        for (uint32_t i = 0; i < instructions; ++i) {
+            const uint32_t kind = random.Below(100);
+            if (kind < 18) { emit({ 0x48, 0x8B, modrm() }); emitRandom(1); }                     // mov r64, [r+disp8]
+            else if (kind < 28) { emit({ 0x48, 0x89, modrm() }); emitRandom(1); }               // mov [r+disp8], r64
+            else if (kind < 36) { emit({ 0xE8 }); emitRandom(4); }                              // call rel32
+            else if (kind < 44) { emit({ 0x48, 0x8D, static_cast<uint8_t>(0x05 | (random.Below(8) << 3)) }); emitRandom(4); } // lea r64, [rip+disp32]
+            else if (kind < 54) { emit({ 0xC5, static_cast<uint8_t>(0xF8 | random.Below(4)), static_cast<uint8_t>(0x10 | random.Below(0x50)), modrm() }); emitRandom(1); } // VEX
+            else if (kind < 60) { emit({ 0xF3, 0x0F, static_cast<uint8_t>(0x10 | random.Below(0x50)), modrm() }); emitRandom(1); } // SSE
+            else if (kind < 68) { emit({ 0x85, static_cast<uint8_t>(0xC0 | random.Below(64)), static_cast<uint8_t>(0x70 | random.Below(16)) }); emitRandom(1); } // test, jcc rel8
+            else if (kind < 72) { emit({ 0x0F, static_cast<uint8_t>(0x80 | random.Below(16)) }); emitRandom(4); } // jcc rel32
+            else if (kind < 78) { emit({ 0x83, static_cast<uint8_t>(0xF8 | random.Below(8)) }); emitRandom(1); } // cmp r32, imm8
+            else if (kind < 84) { emit({ static_cast<uint8_t>(0xB8 | random.Below(8)) }); emitRandom(4); }  // mov r32, imm32
+            else if (kind < 88) emit({ 0x33, 0xC0 });                                           // xor eax, eax
+            else if (kind < 94) { emit({ static_cast<uint8_t>(0x40 | random.Below(16)), 0x8B, static_cast<uint8_t>(0xC0 | random.Below(64)) }); } // REX mov r, r
+            else if (kind < 97) { emit({ 0xC7, 0x44, 0x24 }); emitRandom(5); }                  // mov dword [rsp+disp8], imm32
+            else emit({ static_cast<uint8_t>(0x50 | random.Below(16)) });                        // push/pop
+        }
+
+        emit({ 0x48, 0x83, 0xC4, 0x28, 0xC3 });
+        const uint32_t end = static_cast<uint32_t>(at);
+        while (at < text.size() && (at & 15))
+            text[at++] = 0xCC;
+        functions.push_back({ begin, end });
+    }
+    std::fill(text.begin() + at, text.end(), 0xCC);
+    return functions;
+}
+
+// Every offset in [begin, end) where pattern matches. Walks the pattern's rarest fixed byte with memchr.
+static std::vector<uint32_t> FindAll(const uint8_t* bytes, size_t begin, size_t end, const std::vector<int>& pattern, const size_t histogram[256])
+{
+    std::vector<uint32_t> matches{};
+    size_t anchor = 0;
+    for (size_t j = 0; j < pattern.size(); ++j) {
+        if (pattern[j] != -1 && (pattern[anchor] == -1 || histogram[pattern[j]] < histogram[pattern[anchor]]))
+            anchor = j;
+    }
+    if (end - begin < pattern.size())
+        return matches;
+
+    const uint8_t* p = bytes + begin + anchor;
+    const uint8_t* last = bytes + end - pattern.size() + anchor;
+    while (p <= last && (p = static_cast<const uint8_t*>(memchr(p, pattern[anchor], last - p + 1)))) {
+        const uint8_t* candidate = p - anchor;
+        bool found = true;
+        for (size_t j = 0; j < pattern.size() && found; ++j)
+            found = pattern[j] == -1 || candidate[j] == pattern[j];
+        if (found)
+            matches.push_back(static_cast<uint32_t>(candidate - bytes));
+        ++p;
+    }
+    return matches;
+}
+
+static void Put16(std::vector<uint8_t>& out, size_t at, uint16_t value) { memcpy(&out[at], &value, sizeof(value)); }
+static void Put32(std::vector<uint8_t>& out, size_t at, uint32_t value) { memcpy(&out[at], &value, sizeof(value)); }
+static void Put64(std::vector<uint8_t>& out, size_t at, uint64_t value) { memcpy(&out[at], &value, sizeof(value)); }
+static uint16_t Get16(const std::vector<uint8_t>& in, size_t at) { uint16_t value; memcpy(&value, &in[at], sizeof(value)); return value; }
+static uint32_t Get32(const std::vector<uint8_t>& in, size_t at) { uint32_t value; memcpy(&value, &in[at], sizeof(value)); return value; }
+
+static int Generate(const std::string& path, size_t sizeMB, size_t decoys, uint64_t seed)
+{
+    Random random(seed);
+    std::vector<std::vector<int>> patterns{};
+    for (const char* signature : Signatures::All)
+        patterns.push_back(Memory::PatternToBytes(signature));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> text(std::max<size_t>(sizeMB, 1) << 20);
+    const auto functions = FillCode(text, random);
+
+    // Sites and decoys at random offsets, far enough apart that none overlap.
+    std::vector<Site> sites{};
+    auto place = [&](Site site) {
+        for (;;) {
+            site.offset = random.Below(static_cast<uint32_t>(text.size() - 256)) + 64;
+            bool bClear = true;
+            for (const Site& other : sites)
+                bClear &= (site.offset > other.offset ? site.offset - other.offset : other.offset - site.offset) >= 128;
+            if (bClear)
+                break;
+        }
+        const auto& pattern = patterns[site.signature];
+        for (size_t j = 0; j < pattern.size(); ++j)
+            text[site.offset + j] = (pattern[j] == -1) ? random.Byte() : static_cast<uint8_t>(pattern[j]);
+        if (site.bDecoy)
+            text[site.offset + site.flipped] ^= static_cast<uint8_t>(1 + random.Below(255));
+        sites.push_back(site);
+        };
+
+    for (size_t i = 0; i < SignatureCount; ++i) {
+        place({ false, i, 0, 0 });
+        std::vector<size_t> fixed{};
+        for (size_t j = 0; j < patterns[i].size(); ++j) {
+            if (patterns[i][j] != -1)
+                fixed.push_back(j);
+        }
+        // The first decoy differs only in its last fixed byte, the most expensive near miss for a byte-by-byte scanner.
+        for (size_t d = 0; d < decoys; ++d)
+            place({ true, i, 0, d == 0 ? fixed.back() : fixed[random.Below(static_cast<uint32_t>(fixed.size()))] });
+    }
+    std::sort(sites.begin(), sites.end(), [](const Site& a, const Site& b) { return a.offset < b.offset; });
+
+    // Bytes that can't be touched while scrubbing: all of a site, and the fixed bytes of a decoy.
+    auto isProtected = [&](uint32_t offset) {
+        auto it = std::upper_bound(sites.begin(), sites.end(), offset, [](uint32_t value, const Site& site) { return value < site.offset; });
+        if (it == sites.begin())
+            return false;
+        --it;
+        const auto& pattern = patterns[it->signature];
+        if (offset >= it->offset + pattern.size())
+            return false;
+        return !it->bDecoy || pattern[offset - it->offset] != -1;
+        };
+
+    // Random code will contain accidental matches of the shorter signatures. Break each one by changing a byte it needs,
+    // until the only matches left are the planted sites.
+    size_t scrubbed = 0;
+    for (int pass = 0;; ++pass) {
+        if (pass == 16) {
+            std::cerr << "Could not remove accidental matches." << std::endl;
+            return 1;
+        }
+        size_t histogram[256]{};
+        for (uint8_t byte : text)
+            ++histogram[byte];
+
+        size_t changed = 0;
+        for (size_t i = 0; i < SignatureCount; ++i) {
+            for (uint32_t match : FindAll(text.data(), 0, text.size(), patterns[i], histogram)) {
+                const bool bPlanted = std::any_of(sites.begin(), sites.end(), [&](const Site& site) { return !site.bDecoy && site.signature == i && site.offset == match; });
+                if (bPlanted)
+                    continue;
+                for (size_t j = 0; j < patterns[i].size(); ++j) {
+                    if (patterns[i][j] != -1 && !isProtected(match + static_cast<uint32_t>(j))) {
+                        text[match + j] ^= 0x01;
+                        ++changed;
+                        break;
+                    }
+                }
+            }
+        }
+        scrubbed += changed;
+        if (changed == 0)
+            break;
+    }
+
+    // One shared UNWIND_INFO (version 1, no codes) is enough for the function index.
+    const uint32_t textRawSize = AlignUp(static_cast<uint32_t>(text.size()), FileAlignment);
+    const uint32_t rdataRVA = TextRVA + AlignUp(static_cast<uint32_t>(text.size()), SectionAlignment);
+    const uint32_t rdataSize = 16;
+    const uint32_t pdataRVA = rdataRVA + AlignUp(rdataSize, SectionAlignment);
+    const uint32_t pdataSize = static_cast<uint32_t>(functions.size() * 12);
+    const uint32_t sizeOfImage = pdataRVA + AlignUp(pdataSize, SectionAlignment);
+
+    const uint32_t rdataRaw = HeadersSize + textRawSize;
+    const uint32_t pdataRaw = rdataRaw + AlignUp(rdataSize, FileAlignment);
+    std::vector<uint8_t> file(pdataRaw + AlignUp(pdataSize, FileAlignment));
+
+    // DOS header, PE signature, COFF header.
+    Put16(file, 0x00, 0x5A4D);
+    Put32(file, 0x3C, 0x80);
+    const size_t nt = 0x80;
+    Put32(file, nt, 0x00004550);
+    Put16(file, nt + 4, 0x8664);                // Machine
+    Put16(file, nt + 6, 3);                     // NumberOfSections
+    Put32(file, nt + 8, 0x5F000000);            // TimeDateStamp
+    Put16(file, nt + 20, 240);                  // SizeOfOptionalHeader
+    Put16(file, nt + 22, 0x0022);               // EXECUTABLE_IMAGE | LARGE_ADDRESS_AWARE
+
+    // PE32+ optional header.
+    const size_t optional = nt + 24;
+    Put16(file, optional + 0, 0x20B);
+    Put32(file, optional + 4, textRawSize);     // SizeOfCode
+    Put32(file, optional + 16, TextRVA);        // AddressOfEntryPoint
+    Put32(file, optional + 20, TextRVA);        // BaseOfCode
+    Put64(file, optional + 24, 0x140000000ull); // ImageBase
+    Put32(file, optional + 32, SectionAlignment);
+    Put32(file, optional + 36, FileAlignment);
+    Put16(file, optional + 40, 6);              // MajorOperatingSystemVersion
+    Put16(file, optional + 48, 6);              // MajorSubsystemVersion
+    Put32(file, optional + 56, sizeOfImage);
+    Put32(file, optional + 60, HeadersSize);
+    Put16(file, optional + 68, 2);              // Subsystem: Windows GUI
+    Put16(file, optional + 70, 0x8160);         // DllCharacteristics: high entropy VA, dynamic base, NX, terminal server aware
+    Put64(file, optional + 72, 0x100000);       // SizeOfStackReserve
+    Put64(file, optional + 80, 0x1000);
+    Put64(file, optional + 88, 0x100000);
+    Put64(file, optional + 96, 0x1000);
+    Put32(file, optional + 108, 16);            // NumberOfRvaAndSizes
+    Put32(file, optional + 112 + 3 * 8, pdataRVA);  // IMAGE_DIRECTORY_ENTRY_EXCEPTION
+    Put32(file, optional + 112 + 3 * 8 + 4, pdataSize);
+
+    auto section = [&](size_t index, const char* name, uint32_t virtualSize, uint32_t rva, uint32_t rawSize, uint32_t raw, uint32_t characteristics) {
+        const size_t at = optional + 240 + index * 40;
+        memcpy(&file[at], name, strlen(name));
+        Put32(file, at + 8, virtualSize);
+        Put32(file, at + 12, rva);
+        Put32(file, at + 16, rawSize);
+        Put32(file, at + 20, raw);
+        Put32(file, at + 36, characteristics);
+        };
+    section(0, ".text", static_cast<uint32_t>(text.size()), TextRVA, textRawSize, HeadersSize, CodeCharacteristics);
+    section(1, ".rdata", rdataSize, rdataRVA, AlignUp(rdataSize, FileAlignment), rdataRaw, ReadOnlyCharacteristics);
+    section(2, ".pdata", pdataSize, pdataRVA, AlignUp(pdataSize, FileAlignment), pdataRaw, ReadOnlyCharacteristics);
+
+    std::copy(text.begin(), text.end(), file.begin() + HeadersSize);
+    file[rdataRaw] = 0x01;
+    for (size_t i = 0; i < functions.size(); ++i) {
+        Put32(file, pdataRaw + i * 12, TextRVA + functions[i].first);
+        Put32(file, pdataRaw + i * 12 + 4, TextRVA + functions[i].second);
+        Put32(file, pdataRaw + i * 12 + 8, rdataRVA);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+    std::ofstream manifest(path + ".sites", std::ios::trunc);
+    manifest << "# kind name rva [changed pattern byte]\n";
+    for (const Site& site : sites) {
+        manifest << (site.bDecoy ? "decoy " : "site ") << SignatureNames[site.signature] << " " << std::hex << TextRVA + site.offset;
+        if (site.bDecoy)
+            manifest << " " << std::dec << site.flipped;
+        manifest << "\n";
+    }
+    if (!out || !manifest) {
+        std::cerr << "Could not write " << path << "." << std::endl;
+        return 1;
+    }
+
+    const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::printf("Wrote %s: %zu MB of code, %zu functions, %zu sites, %zu decoys, %zu accidental matches removed (%lldms).\n",
+        path.c_str(), text.size() >> 20, functions.size(), SignatureCount, SignatureCount * decoys, scrubbed, static_cast<long long>(milliseconds));
+    return 0;
+}
+
+struct Image
+{
+    std::vector<uint8_t> file;
+    std::vector<uint8_t> mapped;    // Laid out at RVAs, as the loader would
+    std::vector<Memory::CodeSection> code;  // Code sections of the file on disk
+    uint32_t exceptionRVA = 0, exceptionSize = 0;
+};
+
+static bool Load(const std::string& path, Image& image)
+{
+    std::ifstream in(path, std::ios::binary);
+    image.file.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (image.file.size() < 0x40 || Get16(image.file, 0) != 0x5A4D)
+        return false;
+    const size_t nt = Get32(image.file, 0x3C);
+    if (nt + 24 + 240 > image.file.size() || Get32(image.file, nt) != 0x00004550 || Get16(image.file, nt + 24) != 0x20B)
+        return false;
+
+    const uint16_t sections = Get16(image.file, nt + 6);
+    const size_t table = nt + 24 + Get16(image.file, nt + 20);
+    const uint32_t sizeOfImage = Get32(image.file, nt + 24 + 56);
+    const uint32_t sizeOfHeaders = Get32(image.file, nt + 24 + 60);
+    if (table + sections * 40 > image.file.size() || sizeOfHeaders > image.file.size())
+        return false;
+    image.exceptionRVA = Get32(image.file, nt + 24 + 112 + 3 * 8);
+    image.exceptionSize = Get32(image.file, nt + 24 + 112 + 3 * 8 + 4);
+
+    image.mapped.assign(sizeOfImage, 0);
+    std::copy(image.file.begin(), image.file.begin() + std::min<size_t>(sizeOfHeaders, sizeOfImage), image.mapped.begin());
+    for (uint16_t i = 0; i < sections; ++i) {
+        const size_t at = table + i * 40;
+        const uint32_t virtualSize = Get32(image.file, at + 8);
+        const uint32_t rva = Get32(image.file, at + 12);
+        const uint32_t rawSize = Get32(image.file, at + 16);
+        const uint32_t raw = Get32(image.file, at + 20);
+        if (raw + static_cast<size_t>(rawSize) > image.file.size() || rva + static_cast<size_t>(std::min(rawSize, virtualSize)) > sizeOfImage)
+            return false;
+        std::copy_n(image.file.begin() + raw, std::min(rawSize, virtualSize), image.mapped.begin() + rva);
+        if (Get32(image.file, at + 36) & 0x20)
+            image.code.push_back({ image.file.data() + raw, std::min(rawSize, virtualSize), rva });
+    }
+    return true;
+}
+
+static int Verify(const std::string& path, int iterations)
+{
+    Image image{};
+    if (!Load(path, image)) {
+        std::cerr << "Could not load " << path << " as a PE64 image." << std::endl;
+        return 1;
+    }
+
+    std::map<std::string, size_t> indices{};
+    for (size_t i = 0; i < SignatureCount; ++i)
+        indices[SignatureNames[i]] = i;
+
+    uint32_t planted[SignatureCount]{};
+    std::vector<std::pair<size_t, uint32_t>> decoys{};
+    std::ifstream manifest(path + ".sites");
+    std::string line{};
+    while (std::getline(manifest, line)) {
+        char kind[16]{}, name[64]{};
+        unsigned int rva = 0;
+        if (line.empty() || line[0] == '#' || std::sscanf(line.c_str(), "%15s %63s %x", kind, name, &rva) != 3 || !indices.contains(name))
+            continue;
+        if (std::string(kind) == "site")
+            planted[indices[name]] = rva;
+        else
+            decoys.push_back({ indices[name], rva });
+    }
+    if (std::count(std::begin(planted), std::end(planted), 0u) != 0) {
+        std::cerr << "Missing or incomplete " << path << ".sites." << std::endl;
+        return 1;
+    }
+
+    uint8_t* mapped = image.mapped.data();
+    const size_t sizeOfImage = image.mapped.size();
+    Random random(1);
+
+    Functions::Index functions{};
+    if (!functions.Build(mapped, static_cast<uint32_t>(sizeOfImage), image.exceptionRVA, image.exceptionSize)) {
+        std::cerr << "Could not build the function index from .pdata." << std::endl;
+        return 1;
+    }
+
+    auto rva = [&](const uint8_t* found) { return found ? static_cast<uint32_t>(found - mapped) : ~0u; };
+
+    size_t histogram[256]{};
+    for (uint8_t byte : image.mapped)
+        ++histogram[byte];
+
+    int failures = 0;
+    size_t inFunction = 0;
+    long long best[3] = { ~0ull >> 1, ~0ull >> 1, ~0ull >> 1 };
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        long long timings[3]{};
+        for (size_t i = 0; i < SignatureCount; ++i) {
+            const char* signature = Signatures::All[i];
+            const size_t patternSize = Memory::PatternToBytes(signature).size();
+            const uint64_t fingerprint = Memory::Hash(mapped + planted[i], patternSize);
+            // A stale cache entry after a game update: the site has moved by up to 512KB.
+            const uint32_t hint = static_cast<uint32_t>(std::clamp<int64_t>(static_cast<int64_t>(planted[i]) + static_cast<int64_t>(random.Below(0x100000)) - 0x80000, 0, static_cast<int64_t>(sizeOfImage) - 1));
+
+            Memory::CacheLookup full{}, predicted{}, window{};
+            std::optional<uint32_t> prediction{};
+            auto timed = [&](int variant, auto&& scan) {
+                auto start = std::chrono::steady_clock::now();
+                scan();
+                timings[variant] += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+                };
+            timed(0, [&]() { full = Memory::LookupCached(mapped, sizeOfImage, signature, std::nullopt, std::nullopt); });
+            timed(1, [&]() {
+                prediction = Memory::PredictRVA(image.code, signature);
+                predicted = Memory::LookupCached(mapped, sizeOfImage, signature, std::nullopt, prediction);
+                });
+            timed(2, [&]() { window = Memory::LookupCached(mapped, sizeOfImage, signature, Memory::CacheEntry{ hint, fingerprint }, std::nullopt); });
+            if (iteration > 0)
+                continue;
+
+            const auto exact = Memory::LookupCached(mapped, sizeOfImage, signature, Memory::CacheEntry{ planted[i], fingerprint }, std::nullopt);
+            const auto changed = Memory::LookupCached(mapped, sizeOfImage, signature, Memory::CacheEntry{ hint, fingerprint ^ 1 }, std::nullopt);
+
+            // The same stale entry after an update that also changed the site's wildcard bytes, its rel32s and displacements, so the
+            // cached fingerprint matches nothing. The window must still find the site by its pattern alone. The site is put back after.
+            const auto pattern = Memory::PatternToBytes(signature);
+            const std::vector<uint8_t> original(mapped + planted[i], mapped + planted[i] + patternSize);
+            for (size_t b = 0; b < patternSize; ++b) {
+                if (pattern[b] == -1)
+                    mapped[planted[i] + b] ^= 0xA5;
+            }
+            const bool bRewritten = Memory::Hash(mapped + planted[i], patternSize) != fingerprint;
+            const auto updated = Memory::LookupCached(mapped, sizeOfImage, signature, Memory::CacheEntry{ hint, fingerprint }, std::nullopt);
+            const auto updatedAll = FindAll(mapped, 0, sizeOfImage, pattern, histogram);
+            std::copy(original.begin(), original.end(), mapped + planted[i]);
+
+            // The per-function scan only sees the site if it lies wholly inside one .pdata entry.
+            const Functions::Function* function = functions.Find((uintptr_t)mapped + planted[i]);
+            const bool bInFunction = function && (uintptr_t)mapped + planted[i] + patternSize <= function->end;
+            inFunction += bInFunction;
+            const uint8_t* scoped = Functions::PatternScanFunction(functions, (uintptr_t)mapped + planted[i], signature);
+
+            const auto all = FindAll(mapped, 0, sizeOfImage, pattern, histogram);
+            const bool bPassed = full.outcome == Memory::CacheOutcome::FullScan && rva(full.found) == planted[i]
+                && prediction == planted[i] && predicted.outcome == Memory::CacheOutcome::Predicted && rva(predicted.found) == planted[i]
+                && window.outcome == Memory::CacheOutcome::Window && rva(window.found) == planted[i]
+                && exact.outcome == Memory::CacheOutcome::Exact && rva(exact.found) == planted[i]
+                && changed.outcome == Memory::CacheOutcome::Window && rva(changed.found) == planted[i]
+                && bRewritten && updated.outcome == Memory::CacheOutcome::Window && rva(updated.found) == planted[i]
+                && updatedAll.size() == 1 && updatedAll[0] == planted[i]
+                && scoped == (bInFunction ? mapped + planted[i] : nullptr)
+                && all.size() == 1 && all[0] == planted[i];
+            failures += !bPassed;
+            std::printf("%-22s %8x  full %8x  predicted %8x  window %8x (%#zx)  function %s  matches %zu  %s\n", SignatureNames[i], planted[i],
+                rva(full.found), rva(predicted.found), rva(window.found), window.window, bInFunction ? "yes" : "no ", all.size(), bPassed ? "ok" : "FAILED");
+        }
+        for (int variant = 0; variant < 3; ++variant)
+            best[variant] = std::min(best[variant], timings[variant]);
+    }
+
+    // A cache entry pointing at a decoy must not be taken as a hit, and the lookup must still end at the planted site.
+    size_t decoyFailures = 0;
+    for (const auto& [signature, decoy] : decoys) {
+        const char* pattern = Signatures::All[signature];
+        const uint64_t fingerprint = Memory::Hash(mapped + decoy, Memory::PatternToBytes(pattern).size());
+        const auto lookup = Memory::LookupCached(mapped, sizeOfImage, pattern, Memory::CacheEntry{ decoy, fingerprint }, decoy);
+        decoyFailures += lookup.outcome == Memory::CacheOutcome::Exact || lookup.outcome == Memory::CacheOutcome::Predicted || rva(lookup.found) != planted[signature];
+    }
+    failures += static_cast<int>(decoyFailures);
+
+    std::printf("\n%zu signatures (%zu inside a .pdata function), %zu decoys (%zu matched), %zu functions, %zu MB image.\n", SignatureCount, inFunction,
+        decoys.size(), decoyFailures, functions.Size(), sizeOfImage >> 20);
+    std::printf("Startup scan cost, best of %d: full image %.1fms, on-disk prediction %.1fms, stale cache windows %.1fms.\n",
+        iterations, best[0] / 1000.0, best[1] / 1000.0, best[2] / 1000.0);
+    std::printf("%s\n", failures ? "FAILED" : "All scanners found exactly the planted sites.");
+    return failures ? 2 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    const std::string mode = (argc > 1) ? argv[1] : "";
+    if (argc > 2 && mode == "generate")
+        return Generate(argv[2], (argc > 3) ? std::stoul(argv[3]) : 256, (argc > 4) ? std::stoul(argv[4]) : 4, (argc > 5) ? std::stoull(argv[5]) : 1);
+    if (argc > 2 && mode == "verify")
+        return Verify(argv[2], (argc > 3) ? std::max(1, std::stoi(argv[3])) : 1);
+
+    std::cerr << "Usage: synth_image generate <image> [size MB] [decoys per signature] [seed]" << std::endl;
+    std::cerr << "       synth_image verify <image> [iterations]" << std::endl;
+    return 1;
+}
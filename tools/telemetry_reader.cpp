@@ -0,0 +1,114 @@
+// Reference reader for the MetaphorFix telemetry block (src/telemetry.hpp).
+// On Windows it opens Local\MetaphorFix.Telemetry while the game is running. Elsewhere it uses POSIX shared memory, and
+// "publish" runs a stand-in publisher with made-up values so the reader can be tried without the game:
+//   g++ -std=c++20 -O2 -o telemetry_reader tools/telemetry_reader.cpp
+//   telemetry_reader publish &
+//   telemetry_reader [count] [interval ms]
+
+#include "../src/telemetry.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const char* HookNames[Telemetry::HookCount] = { "ResolutionScale", "AOResolution", "ResolutionFix", "IntroSkip" };
+
+static Telemetry::Block* Map(bool bCreate)
+{
+#ifdef _WIN32
+    if (bCreate)
+        return Telemetry::Open();
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, (std::string("Local\\") + Telemetry::SharedMemoryName).c_str());
+    if (!mapping)
+        return nullptr;
+    return static_cast<Telemetry::Block*>(MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(Telemetry::Block)));
+#else
+    const std::string name = std::string("/") + Telemetry::SharedMemoryName;
+    const int fd = shm_open(name.c_str(), bCreate ? (O_CREAT | O_RDWR) : O_RDWR, 0600);
+    if (fd < 0)
+        return nullptr;
+    if (bCreate && ftruncate(fd, sizeof(Telemetry::Block)) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* view = mmap(nullptr, sizeof(Telemetry::Block), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return nullptr;
+
+    auto* block = static_cast<Telemetry::Block*>(view);
+    if (bCreate)
+        Telemetry::Initialise(*block, static_cast<uint32_t>(getpid()));
+    return block;
+#endif
+}
+
+// Publishes values that change every update, so torn reads would show up as inconsistent fields.
+static int Publish(Telemetry::Block* block)
+{
+    Telemetry::Snapshot snapshot{};
+    snapshot.timerFrequency = 1000000000;
+    for (;;) {
+        ++snapshot.updates;
+        snapshot.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        snapshot.resX = 3440 + static_cast<int32_t>(snapshot.updates % 2) * 400;
+        snapshot.resY = 1440;
+        snapshot.aspectRatio = static_cast<float>(snapshot.resX) / static_cast<float>(snapshot.resY);
+        snapshot.hudWidth = 1440.00f * (16.00f / 9.00f);
+        snapshot.hudHeight = 1440.00f;
+        snapshot.resScaleOption = static_cast<int32_t>(snapshot.updates % 7);
+        snapshot.resScale = 1.00f;
+        snapshot.aoResX = snapshot.resX / 2;
+        snapshot.aoResY = snapshot.resY / 2;
+        snapshot.lodDistance = 10.00f;
+        for (size_t i = 0; i < Telemetry::HookCount; ++i)
+            snapshot.hookHits[i] = snapshot.updates * (i + 1);
+
+        Telemetry::Publish(*block, snapshot);
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool bPublish = (argc > 1 && std::string(argv[1]) == "publish");
+    Telemetry::Block* block = Map(bPublish);
+    if (!block) {
+        std::cerr << "Could not open " << Telemetry::SharedMemoryName << (bPublish ? "." : ", is the game (or the stand-in publisher) running?") << std::endl;
+        return 1;
+    }
+    if (bPublish)
+        return Publish(block);
+
+    const long count = (argc > 1) ? std::stol(argv[1]) : 1;
+    const long interval = (argc > 2) ? std::stol(argv[2]) : 500;
+    uint64_t lastUpdates = 0;
+    for (long i = 0; i < count; ++i) {
+        if (i > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+
+        Telemetry::Snapshot snapshot{};
+        if (!Telemetry::Read(*block, snapshot)) {
+            std::cerr << "No consistent snapshot (not initialised, wrong version, or the publisher is stuck)." << std::endl;
+            return 2;
+        }
+
+        std::printf("update %llu (pid %u)%s\n", static_cast<unsigned long long>(snapshot.updates), block->publisherId, (i > 0 && snapshot.updates == lastUpdates) ? " [stale]" : "");
+        std::printf("  resolution   %dx%d, aspect %.4f, HUD %.1fx%.1f\n", snapshot.resX, snapshot.resY, snapshot.aspectRatio, snapshot.hudWidth, snapshot.hudHeight);
+        std::printf("  res scale    option %d, x%.2f\n", snapshot.resScaleOption, snapshot.resScale);
+        std::printf("  AO           %dx%d\n", snapshot.aoResX, snapshot.aoResY);
+        std::printf("  LOD distance %.2f\n", snapshot.lodDistance);
+        for (size_t hook = 0; hook < Telemetry::HookCount; ++hook)
+            std::printf("  hits %-16s %llu\n", HookNames[hook], static_cast<unsigned long long>(snapshot.hookHits[hook]));
+        lastUpdates = snapshot.updates;
+    }
+    return 0;
+}
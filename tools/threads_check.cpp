@@ -0,0 +1,114 @@
+// Checks the thread scheduling logic (src/threads.hpp) against made-up threads and core topologies.
+//   g++ -std=c++20 -O2 -o threads_check tools/threads_check.cpp
+//   threads_check
+
+#include "../src/threads.hpp"
+
+#include <cstdio>
+#include <string>
+
+static int failures = 0;
+
+static void Check(bool condition, const std::string& what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what.c_str());
+        ++failures;
+    }
+}
+
+// Two logical processors per core with SMT, one without, starting at bit.
+static Threads::Core MakeCore(int bit, bool smt, uint8_t efficiencyClass)
+{
+    return { (smt ? 3ull : 1ull) << bit, efficiencyClass };
+}
+
+static void CheckClassify()
+{
+    struct Case
+    {
+        Threads::ThreadInfo thread;
+        Threads::Role expected;
+    };
+    const Case cases[] = {
+        { { 1, "", "metaphor.exe", true, false }, Threads::Role::Main },
+        { { 2, "", "metaphorfix.asi", false, true }, Threads::Role::Fix },
+        // The fix's own threads win over any name they might have
+        { { 3, "RenderThread", "metaphorfix.asi", false, true }, Threads::Role::Fix },
+        { { 4, "RenderThread", "metaphor.exe", false, false }, Threads::Role::Render },
+        { { 5, "RHI Submission", "metaphor.exe", false, false }, Threads::Role::Render },
+        { { 6, "PRESENT", "metaphor.exe", false, false }, Threads::Role::Render },
+        { { 7, "Audio Mixer", "metaphor.exe", false, false }, Threads::Role::Audio },
+        { { 8, "CRI ADX2 Atom", "metaphor.exe", false, false }, Threads::Role::Audio },
+        { { 9, "", "xaudio2_9.dll", false, false }, Threads::Role::Audio },
+        { { 10, "", "AudioSes.dll", false, false }, Threads::Role::Audio },
+        { { 11, "JobWorker 3", "metaphor.exe", false, false }, Threads::Role::Worker },
+        { { 12, "TaskGraph", "metaphor.exe", false, false }, Threads::Role::Worker },
+        // Description rules are checked before module rules
+        { { 13, "Worker", "xaudio2_9.dll", false, false }, Threads::Role::Worker },
+        { { 14, "", "metaphor.exe", false, false }, Threads::Role::Unknown },
+        { { 15, "Steam overlay", "gameoverlayrenderer64.dll", false, false }, Threads::Role::Unknown },
+        { { 16, "", "", false, false }, Threads::Role::Unknown },
+    };
+    for (const auto& c : cases) {
+        const Threads::Role role = Threads::Classify(c.thread);
+        Check(role == c.expected, "Classify(\"" + c.thread.description + "\", \"" + c.thread.module + "\") = " + Threads::RoleName(role)
+            + ", expected " + Threads::RoleName(c.expected));
+    }
+}
+
+static void CheckTopology(const char* name, const Threads::Topology& topology, bool bHybrid, uint64_t all, uint64_t performance, uint64_t efficiency)
+{
+    auto hex = [](uint64_t value) { char text[32]; snprintf(text, sizeof(text), "%#llx", (unsigned long long)value); return std::string(text); };
+    Check(topology.IsHybrid() == bHybrid, std::string(name) + ": IsHybrid() = " + (topology.IsHybrid() ? "true" : "false"));
+    Check(topology.All() == all, std::string(name) + ": All() = " + hex(topology.All()) + ", expected " + hex(all));
+    Check(topology.Mask(Threads::Cores::Any) == all, std::string(name) + ": Mask(Any) = " + hex(topology.Mask(Threads::Cores::Any)));
+    Check(topology.Mask(Threads::Cores::Performance) == performance, std::string(name) + ": Mask(Performance) = "
+        + hex(topology.Mask(Threads::Cores::Performance)) + ", expected " + hex(performance));
+    Check(topology.Mask(Threads::Cores::Efficiency) == efficiency, std::string(name) + ": Mask(Efficiency) = "
+        + hex(topology.Mask(Threads::Cores::Efficiency)) + ", expected " + hex(efficiency));
+}
+
+static void CheckTopologies()
+{
+    // Empty: nothing reported, every mask is 0 so no affinity is set.
+    CheckTopology("Empty", {}, false, 0, 0, 0);
+
+    // 8 cores with SMT, all one class: every kind is every core.
+    Threads::Topology uniform{};
+    for (int i = 0; i < 8; ++i)
+        uniform.cores.push_back(MakeCore(i * 2, true, 0));
+    CheckTopology("8 uniform cores", uniform, false, 0xFFFF, 0xFFFF, 0xFFFF);
+
+    // 8 P-cores with SMT (class 1) then 16 E-cores (class 0), like a 13900K.
+    Threads::Topology alderLake{};
+    for (int i = 0; i < 8; ++i)
+        alderLake.cores.push_back(MakeCore(i * 2, true, 1));
+    for (int i = 0; i < 16; ++i)
+        alderLake.cores.push_back(MakeCore(16 + i, false, 0));
+    CheckTopology("8P + 16E", alderLake, true, 0xFFFFFFFF, 0xFFFF, 0xFFFF0000);
+
+    // E-cores listed first and interleaved, so the masks can't be assumed to be contiguous.
+    Threads::Topology interleaved{};
+    interleaved.cores = { MakeCore(0, false, 0), MakeCore(1, true, 1), MakeCore(3, false, 0), MakeCore(4, true, 1) };
+    CheckTopology("Interleaved", interleaved, true, 0x3F, 0x36, 0x09);
+
+    // Three classes (prime, performance, efficiency): only the fastest and slowest are picked.
+    Threads::Topology threeClass{};
+    threeClass.cores = { MakeCore(0, false, 2), MakeCore(1, false, 1), MakeCore(2, false, 1), MakeCore(3, false, 0), MakeCore(4, false, 0) };
+    CheckTopology("Three classes", threeClass, true, 0x1F, 0x01, 0x18);
+
+    // All 64 bits of group 0 in use.
+    Threads::Topology full{};
+    for (int i = 0; i < 32; ++i)
+        full.cores.push_back(MakeCore(i * 2, true, i < 8 ? 1 : 0));
+    CheckTopology("64 logical processors", full, true, ~0ull, 0xFFFF, ~0ull << 16);
+}
+
+int main()
+{
+    CheckClassify();
+    CheckTopologies();
+    printf("%s (%d failure(s))\n", failures ? "FAILED" : "All checks passed", failures);
+    return failures ? 1 : 0;
+}
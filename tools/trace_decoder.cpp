@@ -0,0 +1,118 @@
+// Decodes a MetaphorFix binary trace (MetaphorFix.trace) into text or JSON.
+// Portable, no dependencies beyond the standard library:
+//   g++ -std=c++20 -O2 -o trace_decoder tools/trace_decoder.cpp
+//   trace_decoder MetaphorFix.trace [--json]
+
+#include "../src/trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static const char* EventName(uint16_t event)
+{
+    switch (static_cast<Trace::Event>(event)) {
+    case Trace::Event::ResolutionChanged: return "ResolutionChanged";
+    case Trace::Event::TitleStateChanged: return "TitleStateChanged";
+    case Trace::Event::HookHit: return "HookHit";
+    case Trace::Event::FrameLatency: return "FrameLatency";
+    default: return "Unknown";
+    }
+}
+
+static const char* HookName(uint64_t hook)
+{
+    switch (static_cast<Trace::Hook>(hook)) {
+    case Trace::Hook::ResolutionScale: return "ResolutionScale";
+    case Trace::Hook::AOResolution: return "AOResolution";
+    case Trace::Hook::ResolutionFix: return "ResolutionFix";
+    case Trace::Hook::IntroSkip: return "IntroSkip";
+    default: return "Unknown";
+    }
+}
+
+static std::string Describe(const Trace::Record& record)
+{
+    char buffer[128];
+    switch (static_cast<Trace::Event>(record.event)) {
+    case Trace::Event::ResolutionChanged:
+        snprintf(buffer, sizeof(buffer), "%llux%llu", (unsigned long long)record.payload[0], (unsigned long long)record.payload[1]);
+        break;
+    case Trace::Event::TitleStateChanged:
+        snprintf(buffer, sizeof(buffer), "0x%llX -> 0x%llX", (unsigned long long)record.payload[0], (unsigned long long)record.payload[1]);
+        break;
+    case Trace::Event::HookHit:
+        snprintf(buffer, sizeof(buffer), "%s #%llu", HookName(record.payload[0]), (unsigned long long)record.payload[1]);
+        break;
+    case Trace::Event::FrameLatency:
+        snprintf(buffer, sizeof(buffer), "sim to present %.2fms, present to GPU done %.2fms", record.payload[0] / 1000.0, record.payload[1] / 1000.0);
+        break;
+    default:
+        snprintf(buffer, sizeof(buffer), "0x%llX 0x%llX", (unsigned long long)record.payload[0], (unsigned long long)record.payload[1]);
+        break;
+    }
+    return buffer;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <MetaphorFix.trace> [--json]" << std::endl;
+        return 1;
+    }
+    const bool json = (argc > 2 && std::string(argv[2]) == "--json");
+
+    std::ifstream file(argv[1], std::ios::binary);
+    Trace::FileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::cerr << "Could not read trace header." << std::endl;
+        return 1;
+    }
+    if (memcmp(header.magic, Trace::Magic, sizeof(Trace::Magic)) != 0 || header.version != Trace::Version || header.recordSize != sizeof(Trace::Record)) {
+        std::cerr << "Not a supported trace file." << std::endl;
+        return 1;
+    }
+
+    std::vector<Trace::Record> records(header.capacity);
+    file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(Trace::Record));
+    records.resize(file.gcount() / sizeof(Trace::Record));
+
+    // writeIndex may lag behind if the process died mid-write, so order by each record's own sequence.
+    std::vector<Trace::Record> valid{};
+    for (size_t i = 0; i < records.size(); ++i) {
+        const auto& record = records[i];
+        if (record.sequence != 0 && (record.sequence - 1) % header.capacity == i)
+            valid.push_back(record);
+    }
+    std::sort(valid.begin(), valid.end(), [](const auto& a, const auto& b) { return a.sequence < b.sequence; });
+
+    const uint64_t frequency = header.timerFrequency ? header.timerFrequency : 1;
+    const uint64_t origin = valid.empty() ? 0 : valid.front().timestamp;
+
+    if (json)
+        std::cout << "{\"written\":" << header.writeIndex << ",\"capacity\":" << header.capacity << ",\"events\":[";
+
+    for (size_t i = 0; i < valid.size(); ++i) {
+        const auto& record = valid[i];
+        const double ms = static_cast<double>(record.timestamp - origin) * 1000.0 / static_cast<double>(frequency);
+        if (json) {
+            std::cout << (i ? "," : "") << "\n{\"seq\":" << record.sequence << ",\"ms\":" << ms
+                << ",\"event\":\"" << EventName(record.event) << "\",\"payload\":[" << record.payload[0] << "," << record.payload[1]
+                << "],\"text\":\"" << Describe(record) << "\"}";
+        }
+        else {
+            char line[64];
+            snprintf(line, sizeof(line), "%10llu %12.3fms  ", (unsigned long long)record.sequence, ms);
+            std::cout << line << EventName(record.event) << "  " << Describe(record) << "\n";
+        }
+    }
+
+    if (json)
+        std::cout << "\n]}" << std::endl;
+    else
+        std::cout << valid.size() << " record(s), " << header.writeIndex << " written in total." << std::endl;
+    return 0;
+}